@@ -0,0 +1,96 @@
+#ifndef _DEVICE_ARENA_HPP_
+#define _DEVICE_ARENA_HPP_
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <CL/sycl.hpp>
+
+/*
+    Bump allocator over one device USM block
+    - Reserve once per sycl::queue before anything is timed, hand out
+      aligned sub-allocations, so allocation cost stays out of the measurements
+    - reset() releases everything in O(1) so benchmark iterations do not
+      pay for sycl::malloc_device/sycl::free
+    - Throws std::length_error when the block is exhausted, so an undersized
+      reservation fails on the host instead of in a kernel writing through
+      a null pointer; the benchmark mains catch it and print the bytes needed
+*/
+class DeviceArena
+{
+public:
+    static constexpr std::size_t DefaultAlignment = 256;
+
+    DeviceArena(sycl::queue &Q, std::size_t Capacity, std::size_t Alignment = DefaultAlignment)
+        : m_queue(Q), m_capacity(Capacity), m_alignment(Alignment), m_offset(0), m_highWaterMark(0)
+    {
+        m_base = static_cast<char *>(sycl::aligned_alloc_device(Alignment, Capacity, Q));
+        if (m_base == nullptr)
+        {
+            m_capacity = 0;
+        }
+    };
+    ~DeviceArena()
+    {
+        if (m_base != nullptr)
+        {
+            sycl::free(m_base, m_queue);
+        }
+    };
+
+    DeviceArena(const DeviceArena &) = delete;
+    DeviceArena &operator=(const DeviceArena &) = delete;
+
+    template<typename T>
+    T *allocate(std::size_t Count)
+    {
+        std::size_t Start = (m_offset + m_alignment - 1) / m_alignment * m_alignment;
+        std::size_t End = Start + Count * sizeof(T);
+        if (m_base == nullptr || End > m_capacity)
+        {
+            throw std::length_error("DeviceArena exhausted: " + std::to_string(End) + " bytes needed, "
+                                    + std::to_string(m_capacity) + " reserved");
+        }
+
+        m_offset = End;
+        m_highWaterMark = std::max(m_highWaterMark, m_offset);
+        return reinterpret_cast<T *>(m_base + Start);
+    }
+
+    void reset()
+    {
+        m_offset = 0;
+    }
+
+    std::size_t used() const
+    {
+        return m_offset;
+    }
+
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    std::size_t high_water_mark() const
+    {
+        return m_highWaterMark;
+    }
+
+    /*
+        Bytes to reserve so Count elements of T fit at any alignment
+    */
+    template<typename T>
+    static std::size_t footprint(std::size_t Count, std::size_t Alignment = DefaultAlignment)
+    {
+        return Count * sizeof(T) + Alignment;
+    }
+
+private:
+    sycl::queue m_queue;
+    char *m_base;
+    std::size_t m_capacity;
+    std::size_t m_alignment;
+    std::size_t m_offset;
+    std::size_t m_highWaterMark;
+};
+#endif
@@ -0,0 +1,98 @@
+#ifndef _DEVICE_VERIFY_HPP_
+#define _DEVICE_VERIFY_HPP_
+#include <climits>
+#include <iostream>
+#include <string>
+#include <CL/sycl.hpp>
+#include "device_arena.hpp"
+
+/*
+    Device-side result verification
+    - One parallel_for with two reductions: the number of elements that differ
+      from Expected(i) and the smallest such index
+    - Only two ints come back to the host, so it is a single read of the
+      result vector on the device instead of a copy plus a serial host loop
+    - The scratch ints come from the run's DeviceArena, reserve
+      verify_footprint() bytes for them
+*/
+struct VerifyResult
+{
+    int Mismatches;
+    int FirstBadIndex; // -1 if every element matched
+
+    bool ok() const
+    {
+        return Mismatches == 0;
+    }
+};
+
+std::size_t verify_footprint()
+{
+    return DeviceArena::footprint<int>(2);
+}
+
+/*
+    ExpectedType must provide:
+        T operator()(int Index) const;
+*/
+template<typename T, typename ExpectedType>
+VerifyResult verify_on_device(sycl::queue &Q, DeviceArena &Arena, const T *Data, std::size_t Count, ExpectedType Expected,
+    sycl::event *VerifyEvent = nullptr)
+{
+    int *Scratch = Arena.allocate<int>(2);
+    int *Mismatches = Scratch;
+    int *FirstBad = Scratch + 1;
+
+    sycl::event Event = Q.submit([&](sycl::handler &h)
+    {
+        auto MismatchReduction = sycl::reduction(Mismatches, sycl::plus<int>(),
+            sycl::property_list{sycl::property::reduction::initialize_to_identity()});
+        auto FirstBadReduction = sycl::reduction(FirstBad, sycl::minimum<int>(),
+            sycl::property_list{sycl::property::reduction::initialize_to_identity()});
+
+        h.parallel_for(sycl::range<1>{Count}, MismatchReduction, FirstBadReduction, [=](sycl::id<1> idx, auto &MismatchSum, auto &FirstMin)
+        {
+            int Index = idx[0];
+            if (!(Data[Index] == Expected(Index)))
+            {
+                MismatchSum += 1;
+                FirstMin.combine(Index);
+            }
+        });
+    });
+
+    int Host[2] = {0, INT_MAX};
+    Q.memcpy(Host, Scratch, sizeof(Host), Event);
+    Q.wait();
+
+    if (VerifyEvent)
+    {
+        *VerifyEvent = Event;
+    }
+    return {Host[0], Host[0] == 0 ? -1 : Host[1]};
+}
+
+/*
+    Prints what went wrong, returns Result.ok()
+*/
+bool report_verification(const std::string &Variant, std::size_t VecSize, const VerifyResult &Result)
+{
+    if (!Result.ok())
+    {
+        std::cerr << Variant << " incorrect for size " << VecSize << ": " << Result.Mismatches
+                  << " mismatches, first at index " << Result.FirstBadIndex << "\n";
+    }
+    return Result.ok();
+}
+
+/*
+    Every vector add variant computes 1 + 0
+*/
+struct ExpectedVectorAdd
+{
+    int operator()(int) const
+    {
+        return 1;
+    }
+};
+#endif
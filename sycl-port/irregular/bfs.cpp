@@ -0,0 +1,244 @@
+#ifndef _BFS_CPP_
+#define _BFS_CPP_
+#include <climits>
+#include <queue>
+#include "ir_common.cpp"
+
+/*
+    Breadth-first search levels from one source over a directed CSR graph
+    with power-law out-degrees
+    - Task path: one task per vertex, created on the device as vertices are
+      reached; the work-items relax the neighbours of their vertex with
+      fetch_min, the master then pushes every neighbour it improved onto its
+      own deque. Tasks run in stealing order rather than level order, so a
+      vertex is queued again whenever a shorter path to it turns up; the
+      executed tasks are counted on the device and reported as Tasks
+    - Baseline: one kernel per BFS level over all vertices, each level that
+      reaches a new vertex stamps its number into a flag the host reads to
+      decide whether to go on; every reached vertex is expanded once, so
+      its Tasks are the reached vertices
+*/
+constexpr int Unreached = INT_MAX;
+
+struct BfsTask
+{
+    DeviceCsr Graph;
+    int *Level;
+    int *Discovered; // set when Level was lowered and the vertex still has to be pushed
+    int *TasksLeft;
+    int *Overflow; // set if a push failed because the deque was full
+    int *Executed; // number of execute() calls
+
+    using atomicInt = sycl::atomic_ref<int, sycl::memory_order::acq_rel, sycl::memory_scope::device,
+        sycl::access::address_space::global_space>;
+
+    void execute(int Vertex) const
+    {
+        atomicInt(*Executed).fetch_add(1);
+        int Next = atomicInt(Level[Vertex]).load() + 1;
+        for (int e = Graph.RowOffsets[Vertex]; e < Graph.RowOffsets[Vertex + 1]; e++)
+        {
+            int Neighbour = Graph.Columns[e];
+            if (atomicInt(Level[Neighbour]).fetch_min(Next) > Next)
+            {
+                atomicInt(Discovered[Neighbour]).store(1);
+            }
+        }
+    }
+
+    /*
+        Called on the master only, after execute(Vertex) finished
+    */
+    template<typename Queue>
+    void solve_dependencies(int Vertex, Queue &TaskQueue) const
+    {
+        for (int e = Graph.RowOffsets[Vertex]; e < Graph.RowOffsets[Vertex + 1]; e++)
+        {
+            int Neighbour = Graph.Columns[e];
+            atomicInt Flag(Discovered[Neighbour]);
+            if (Flag.load() == 1 && Flag.exchange(0) == 1)
+            {
+                // count the new task before the batch that created it is retired
+                if (TaskQueue.push(Neighbour))
+                {
+                    atomicInt(*TasksLeft).fetch_add(1);
+                }
+                else
+                {
+                    atomicInt(*Overflow).store(1);
+                }
+            }
+        }
+    }
+};
+
+std::vector<int> serial_bfs(const HostCsr &Graph, int Source)
+{
+    std::vector<int> Level(Graph.NumRows, Unreached);
+    std::queue<int> Frontier;
+    Level[Source] = 0;
+    Frontier.push(Source);
+    while (!Frontier.empty())
+    {
+        int Vertex = Frontier.front();
+        Frontier.pop();
+        for (int e = Graph.RowOffsets[Vertex]; e < Graph.RowOffsets[Vertex + 1]; e++)
+        {
+            int Neighbour = Graph.Columns[e];
+            if (Level[Neighbour] == Unreached)
+            {
+                Level[Neighbour] = Level[Vertex] + 1;
+                Frontier.push(Neighbour);
+            }
+        }
+    }
+    return Level;
+}
+
+bool bfs_bench(sycl::queue &Q, int NumVertices, int MaxDegree, int Reps)
+{
+    const int Source = 0;
+    HostCsr HostGraph = power_law_csr(NumVertices, MaxDegree, 1.0, 9);
+    std::vector<int> Reference = serial_bfs(HostGraph, Source);
+    std::vector<int> HostLevel(NumVertices);
+
+    int Reached = 0;
+    int Depth = 0;
+    for (int l : Reference)
+    {
+        if (l == Unreached) continue;
+        Reached++;
+        Depth = std::max(Depth, l + 1);
+    }
+
+    DeviceCsr Graph = make_device_csr(Q, HostGraph);
+    int *Level = sycl::malloc_device<int>(NumVertices, Q);
+    int *Discovered = sycl::malloc_device<int>(NumVertices, Q);
+    int *Flag = sycl::malloc_device<int>(1, Q); // overflow for the task path, last level that changed for the baseline
+    int *Executed = sycl::malloc_device<int>(1, Q);
+    int HostFlag = 0;
+    int HostExecuted = 0;
+
+    TaskQueueRun Run = make_task_queue_run(Q, {Source});
+    Run.Overflow = Flag;
+    BfsTask Task{Graph, Level, Discovered, Run.TasksLeft, Flag, Executed};
+
+    auto reset_levels = [&]()
+    {
+        Q.fill(Level, Unreached, NumVertices);
+        Q.fill(Discovered, 0, NumVertices);
+        Q.fill(Flag, 0, 1);
+        Q.wait();
+        Q.fill(Level + Source, 0, 1);
+        Q.wait();
+    };
+
+    bool AllCorrect = true;
+    auto check = [&]()
+    {
+        Q.memcpy(HostLevel.data(), Level, NumVertices * sizeof(int));
+        Q.wait();
+        bool IsCorrect = HostLevel == Reference;
+        AllCorrect &= IsCorrect;
+        return IsCorrect;
+    };
+
+    double TaskTime = median_time(Reps, [&]()
+    {
+        reset_levels();
+        Q.fill(Executed, 0, 1);
+        reset_task_queue_run(Q, Run, 1);
+    }, [&]()
+    {
+        task_queue_execute(Q, Run, Task);
+    });
+
+    Q.memcpy(&HostFlag, Flag, sizeof(int));
+    Q.memcpy(&HostExecuted, Executed, sizeof(int));
+    Q.wait();
+    if (HostFlag)
+    {
+        std::cerr << "BFS task deque overflowed, raise IrDequeCapacity" << "\n";
+        AllCorrect = false;
+    }
+    print_ir_row("bfs", "task-queue", NumVertices, HostExecuted, Depth, TaskTime, check());
+
+    double LevelTime = median_time(Reps, reset_levels, [&]()
+    {
+        for (int Current = 0; ; Current++)
+        {
+            sycl::event LevelEvent = Q.parallel_for(NumVertices, [=](sycl::id<1> idx)
+            {
+                using atomicInt = sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                    sycl::access::address_space::global_space>;
+
+                int Vertex = idx[0];
+                if (atomicInt(Level[Vertex]).load() != Current)
+                {
+                    return;
+                }
+                for (int e = Graph.RowOffsets[Vertex]; e < Graph.RowOffsets[Vertex + 1]; e++)
+                {
+                    atomicInt Neighbour(Level[Graph.Columns[e]]);
+                    if (Neighbour.load() == Unreached)
+                    {
+                        Neighbour.store(Current + 1);
+                        atomicInt(*Flag).store(Current + 1);
+                    }
+                }
+            });
+            Q.memcpy(&HostFlag, Flag, sizeof(int), LevelEvent);
+            Q.wait();
+            if (HostFlag != Current + 1)
+            {
+                break;
+            }
+        }
+    });
+    print_ir_row("bfs", "level-sync", NumVertices, Reached, Depth, LevelTime, check());
+
+    free_task_queue_run(Q, Run);
+    free_device_csr(Q, Graph);
+    sycl::free(Level, Q);
+    sycl::free(Discovered, Q);
+    sycl::free(Flag, Q);
+    sycl::free(Executed, Q);
+
+    return AllCorrect;
+}
+
+#ifndef IR_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    int NumVertices = 1 << 16;
+    int MaxDegree = 1 << 10;
+    int Reps = 5;
+    if (argc >= 3)
+    {
+        NumVertices = std::atoi(argv[1]);
+        MaxDegree = std::atoi(argv[2]);
+    }
+    if (argc == 4)
+    {
+        Reps = std::atoi(argv[3]);
+    }
+    if (NumVertices <= 0 || MaxDegree <= 0 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Vertices> <Max Out-Degree> [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::queue Q(device_selector);
+    std::cerr << Q.get_device();
+
+    print_ir_header();
+    if (!bfs_bench(Q, NumVertices, MaxDegree, Reps))
+    {
+        std::cerr << "BFS incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif
+#endif
@@ -0,0 +1,48 @@
+/*
+    Irregular workload suite, every workload through the task queues and
+    through its level-synchronous baseline on one sycl::queue
+    - tiled Cholesky: DAG of tile kernels that narrows step by step
+    - Smith-Waterman: anti-diagonal wavefront of blocks
+    - CSR SpMV: independent rows with power-law lengths
+    - BFS: tasks created on the device as the search goes
+
+    Usage: ir_bench [Repetitions]
+*/
+#define IR_BENCH_DRIVER
+#include "tiled_cholesky.cpp"
+#include "smith_waterman.cpp"
+#include "spmv_csr.cpp"
+#include "bfs.cpp"
+
+int main(int argc, char **argv)
+{
+    int Reps = 5;
+    if (argc == 2)
+    {
+        Reps = std::atoi(argv[1]);
+    }
+    if (Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::queue Q(device_selector);
+    std::cerr << Q.get_device();
+
+    print_ir_header();
+
+    bool AllCorrect = true;
+    AllCorrect &= cholesky_bench(Q, 16, 16, Reps);
+    AllCorrect &= smith_waterman_bench(Q, 4096, 64, Reps);
+    AllCorrect &= spmv_bench(Q, 1 << 18, 16, Reps);
+    AllCorrect &= bfs_bench(Q, 1 << 16, 1 << 10, Reps);
+
+    if (!AllCorrect)
+    {
+        std::cerr << "At least one irregular workload produced a wrong result!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+#ifndef _IR_COMMON_CPP_
+#define _IR_COMMON_CPP_
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/ChaseLevDeque.hpp"
+#include "../tasking/Scheduler.hpp"
+#include "../tasking/TaskGraph.hpp"
+
+/*
+    Shared pieces of the irregular workloads
+    - Every workload runs two ways:
+        task queues: one persistent stealing_execute launch, dependencies
+        resolved on the device as tasks finish
+        level-synchronous: one kernel launch and host wait per DAG level
+    - Both results are checked against a serial host reference
+    - Tasks is the number of tasks the run executed, the DAG size unless a
+      workload re-queues work (BFS)
+    - Times are wall clock around the launch(es), median of Reps runs
+*/
+constexpr std::size_t IrWorkGroupSize = 32;
+constexpr int IrDequeCapacity = 1 << 16;
+
+using IrDequeType = ChaseLevDeque<int, IrDequeCapacity>;
+
+void print_ir_header()
+{
+    std::cout << "Workload,Path,ProblemSize,Tasks,Levels,ExecTime(ms),Correct" << "\n";
+}
+
+void print_ir_row(const std::string &Workload, const std::string &Path, int ProblemSize, int Tasks, int Levels, double Time, bool Correct)
+{
+    std::cout << Workload << "," << Path << "," << ProblemSize << "," << Tasks << "," << Levels << "," << Time << ","
+              << std::boolalpha << Correct << "\n";
+}
+
+/*
+    Tasks of a DAG grouped by level, the longest path from a root
+*/
+std::vector<std::vector<int>> dag_levels(const std::vector<std::vector<int>> &SuccessorLists)
+{
+    const int NumTasks = SuccessorLists.size();
+    std::vector<int> InDegree(NumTasks, 0);
+    for (const auto &Successors : SuccessorLists)
+    {
+        for (int Successor : Successors)
+        {
+            InDegree[Successor] += 1;
+        }
+    }
+
+    std::vector<int> Level(NumTasks, 0);
+    std::vector<int> Ready;
+    for (int i = 0; i < NumTasks; i++)
+    {
+        if (InDegree[i] == 0) Ready.push_back(i);
+    }
+
+    std::vector<std::vector<int>> Levels;
+    while (!Ready.empty())
+    {
+        int TaskId = Ready.back();
+        Ready.pop_back();
+        if (Level[TaskId] >= static_cast<int>(Levels.size()))
+        {
+            Levels.resize(Level[TaskId] + 1);
+        }
+        Levels[Level[TaskId]].push_back(TaskId);
+
+        for (int Successor : SuccessorLists[TaskId])
+        {
+            Level[Successor] = std::max(Level[Successor], Level[TaskId] + 1);
+            if (--InDegree[Successor] == 0)
+            {
+                Ready.push_back(Successor);
+            }
+        }
+    }
+    return Levels;
+}
+
+/*
+    Level-synchronous schedule of a DAG
+    - Tasks of level l are Tasks[Offsets[l] .. Offsets[l + 1])
+*/
+struct LevelSchedule
+{
+    std::vector<int> Offsets; // host
+    int *Tasks; // device
+
+    int num_levels() const
+    {
+        return Offsets.size() - 1;
+    }
+};
+
+LevelSchedule make_level_schedule(sycl::queue &Q, const std::vector<std::vector<int>> &SuccessorLists)
+{
+    LevelSchedule Schedule;
+    Schedule.Offsets.push_back(0);
+
+    std::vector<int> HostTasks;
+    for (const auto &Level : dag_levels(SuccessorLists))
+    {
+        HostTasks.insert(HostTasks.end(), Level.begin(), Level.end());
+        Schedule.Offsets.push_back(HostTasks.size());
+    }
+
+    Schedule.Tasks = sycl::malloc_device<int>(std::max<std::size_t>(HostTasks.size(), 1), Q);
+    Q.memcpy(Schedule.Tasks, HostTasks.data(), HostTasks.size() * sizeof(int));
+    Q.wait();
+    return Schedule;
+}
+
+void free_level_schedule(sycl::queue &Q, LevelSchedule &Schedule)
+{
+    sycl::free(Schedule.Tasks, Q);
+}
+
+/*
+    One kernel per level, the host waits for each level before the next
+*/
+template<typename BodyType>
+void level_sync_execute(sycl::queue &Q, const LevelSchedule &Schedule, BodyType Body)
+{
+    const int *Tasks = Schedule.Tasks;
+    for (int Level = 0; Level < Schedule.num_levels(); Level++)
+    {
+        int First = Schedule.Offsets[Level];
+        int Count = Schedule.Offsets[Level + 1] - First;
+        Q.parallel_for(Count, [=](sycl::id<1> idx)
+        {
+            Body(Tasks[First + idx[0]]);
+        });
+        Q.wait();
+    }
+}
+
+/*
+    Device state of the persistent task-queue path
+    - Roots == nullptr starts from tasks 0..NumRoots-1
+    - Overflow is handed to the scheduler, point it at the flag the tasks
+      set when a push fails (TaskGraph::Overflow) so the launch stops
+      instead of waiting for a task that was dropped
+*/
+struct TaskQueueRun
+{
+    IrDequeType *Deques;
+    int NumWorkGroups;
+    int *TasksLeft;
+    int *Roots;
+    int NumRoots;
+    int *Overflow;
+};
+
+/*
+    A group pushes every task it releases onto its own deque, so a DAG with
+    more tasks than one deque holds can drop ready tasks
+*/
+bool fits_task_deque(const std::string &Workload, int NumTasks)
+{
+    if (NumTasks > IrDequeCapacity)
+    {
+        std::cerr << Workload << ": " << NumTasks << " tasks exceed IrDequeCapacity (" << IrDequeCapacity << ")" << "\n";
+        return false;
+    }
+    return true;
+}
+
+TaskQueueRun make_task_queue_run(sycl::queue &Q, const std::vector<int> &Roots)
+{
+    TaskQueueRun Run;
+    Run.NumWorkGroups = Q.get_device().get_info<sycl::info::device::max_compute_units>();
+    Run.Deques = sycl::malloc_device<IrDequeType>(Run.NumWorkGroups, Q);
+    Run.TasksLeft = sycl::malloc_device<int>(1, Q);
+    Run.NumRoots = Roots.size();
+    Run.Roots = nullptr;
+    Run.Overflow = nullptr;
+    if (!Roots.empty())
+    {
+        Run.Roots = sycl::malloc_device<int>(Roots.size(), Q);
+        Q.memcpy(Run.Roots, Roots.data(), Roots.size() * sizeof(int));
+        Q.wait();
+    }
+    return Run;
+}
+
+/*
+    Task-queue run starting from tasks 0..NumTasks-1, for work without a DAG
+*/
+TaskQueueRun make_independent_run(sycl::queue &Q, int NumTasks)
+{
+    TaskQueueRun Run = make_task_queue_run(Q, std::vector<int>{});
+    Run.NumRoots = NumTasks;
+    return Run;
+}
+
+void free_task_queue_run(sycl::queue &Q, TaskQueueRun &Run)
+{
+    sycl::free(Run.Deques, Q);
+    sycl::free(Run.TasksLeft, Q);
+    if (Run.Roots)
+    {
+        sycl::free(Run.Roots, Q);
+    }
+}
+
+/*
+    Empty deques and TasksLeft = TotalTasks, kept out of the timed region
+*/
+void reset_task_queue_run(sycl::queue &Q, const TaskQueueRun &Run, int TotalTasks)
+{
+    init_task_queues(Q, Run.Deques, Run.NumWorkGroups);
+    Q.fill(Run.TasksLeft, TotalTasks, 1);
+    Q.wait();
+}
+
+template<typename TaskType>
+void task_queue_execute(sycl::queue &Q, const TaskQueueRun &Run, TaskType Task)
+{
+    StealingData<IrDequeType> Data{Run.Deques, Run.NumWorkGroups, Run.NumRoots, Run.TasksLeft, true, Run.Roots, Run.Overflow};
+    stealing_execute<IrWorkGroupSize>(Q, Data, Task);
+    Q.wait();
+}
+
+/*
+    Wall clock time of Run(), Setup() runs untimed before every repetition
+*/
+template<typename SetupType, typename RunType>
+double median_time(int Reps, SetupType Setup, RunType Run)
+{
+    std::vector<double> Times;
+    for (int Rep = 0; Rep < Reps; Rep++)
+    {
+        Setup();
+        auto StartTimePoint = std::chrono::high_resolution_clock::now();
+        Run();
+        auto EndTimePoint = std::chrono::high_resolution_clock::now();
+        Times.push_back(std::chrono::duration<double, std::milli>(EndTimePoint - StartTimePoint).count());
+    }
+    return median(Times);
+}
+
+/*
+    Host CSR matrix / graph
+*/
+struct HostCsr
+{
+    int NumRows;
+    std::vector<int> RowOffsets;
+    std::vector<int> Columns;
+};
+
+/*
+    Row lengths follow a power law, MaxRowLength / rank^Alpha with the ranks
+    shuffled over the rows, so a few rows hold most of the entries
+    - Columns are uniform random, at least one entry per row
+*/
+HostCsr power_law_csr(int NumRows, int MaxRowLength, double Alpha, unsigned int Seed)
+{
+    std::mt19937 Gen(Seed);
+    std::vector<int> Rank(NumRows);
+    std::iota(Rank.begin(), Rank.end(), 1);
+    std::shuffle(Rank.begin(), Rank.end(), Gen);
+
+    std::uniform_int_distribution<int> Column(0, NumRows - 1);
+
+    HostCsr Csr;
+    Csr.NumRows = NumRows;
+    Csr.RowOffsets.push_back(0);
+    for (int Row = 0; Row < NumRows; Row++)
+    {
+        int Length = std::max(1, static_cast<int>(MaxRowLength / std::pow(Rank[Row], Alpha)));
+        for (int e = 0; e < Length; e++)
+        {
+            Csr.Columns.push_back(Column(Gen));
+        }
+        Csr.RowOffsets.push_back(Csr.Columns.size());
+    }
+    return Csr;
+}
+
+struct DeviceCsr
+{
+    int NumRows;
+    int *RowOffsets;
+    int *Columns;
+};
+
+DeviceCsr make_device_csr(sycl::queue &Q, const HostCsr &Csr)
+{
+    DeviceCsr Device{Csr.NumRows, sycl::malloc_device<int>(Csr.RowOffsets.size(), Q), sycl::malloc_device<int>(Csr.Columns.size(), Q)};
+    Q.memcpy(Device.RowOffsets, Csr.RowOffsets.data(), Csr.RowOffsets.size() * sizeof(int));
+    Q.memcpy(Device.Columns, Csr.Columns.data(), Csr.Columns.size() * sizeof(int));
+    Q.wait();
+    return Device;
+}
+
+void free_device_csr(sycl::queue &Q, DeviceCsr &Csr)
+{
+    sycl::free(Csr.RowOffsets, Q);
+    sycl::free(Csr.Columns, Q);
+}
+#endif
@@ -0,0 +1,203 @@
+#ifndef _SMITH_WATERMAN_CPP_
+#define _SMITH_WATERMAN_CPP_
+#include "ir_common.cpp"
+
+/*
+    Smith-Waterman local alignment score matrix, linear gap penalty
+    - H is (Length + 1) x (Length + 1) ints, row and column 0 stay zero
+    - One task per BlockSize x BlockSize block, executed by a single
+      work-item; block (i, j) needs its upper and left neighbours, so the
+      ready blocks form an anti-diagonal wavefront that first grows and
+      then shrinks
+*/
+constexpr int MatchScore = 2;
+constexpr int MismatchScore = -1;
+constexpr int GapScore = -1;
+
+struct WavefrontBody
+{
+    int *H;
+    const char *SeqA;
+    const char *SeqB;
+    int Length;
+    int BlockSize;
+    int NumBlocks; // per dimension
+
+    void operator()(int TaskId) const
+    {
+        int FirstRow = (TaskId / NumBlocks) * BlockSize + 1;
+        int FirstColumn = (TaskId % NumBlocks) * BlockSize + 1;
+        int LastRow = std::min(FirstRow + BlockSize, Length + 1);
+        int LastColumn = std::min(FirstColumn + BlockSize, Length + 1);
+        const int Stride = Length + 1;
+
+        for (int i = FirstRow; i < LastRow; i++)
+        {
+            for (int j = FirstColumn; j < LastColumn; j++)
+            {
+                int Diagonal = H[(i - 1) * Stride + j - 1] + (SeqA[i - 1] == SeqB[j - 1] ? MatchScore : MismatchScore);
+                int Up = H[(i - 1) * Stride + j] + GapScore;
+                int Left = H[i * Stride + j - 1] + GapScore;
+                H[i * Stride + j] = std::max(std::max(0, Diagonal), std::max(Up, Left));
+            }
+        }
+    }
+};
+
+std::vector<std::vector<int>> wavefront_dag(int NumBlocks)
+{
+    std::vector<std::vector<int>> SuccessorLists(NumBlocks * NumBlocks);
+    for (int i = 0; i < NumBlocks; i++)
+    {
+        for (int j = 0; j < NumBlocks; j++)
+        {
+            if (i + 1 < NumBlocks) SuccessorLists[i * NumBlocks + j].push_back((i + 1) * NumBlocks + j);
+            if (j + 1 < NumBlocks) SuccessorLists[i * NumBlocks + j].push_back(i * NumBlocks + j + 1);
+        }
+    }
+    return SuccessorLists;
+}
+
+std::string random_sequence(int Length, unsigned int Seed)
+{
+    std::mt19937 Gen(Seed);
+    std::uniform_int_distribution<int> Base(0, 3);
+    std::string Sequence(Length, 'A');
+    for (char &c : Sequence)
+    {
+        c = "ACGT"[Base(Gen)];
+    }
+    return Sequence;
+}
+
+/*
+    Serial reference, row by row
+*/
+std::vector<int> serial_smith_waterman(const std::string &SeqA, const std::string &SeqB)
+{
+    const int Length = SeqA.size();
+    const int Stride = Length + 1;
+    std::vector<int> H(Stride * Stride, 0);
+    for (int i = 1; i <= Length; i++)
+    {
+        for (int j = 1; j <= Length; j++)
+        {
+            int Diagonal = H[(i - 1) * Stride + j - 1] + (SeqA[i - 1] == SeqB[j - 1] ? MatchScore : MismatchScore);
+            int Up = H[(i - 1) * Stride + j] + GapScore;
+            int Left = H[i * Stride + j - 1] + GapScore;
+            H[i * Stride + j] = std::max({0, Diagonal, Up, Left});
+        }
+    }
+    return H;
+}
+
+bool smith_waterman_bench(sycl::queue &Q, int Length, int BlockSize, int Reps)
+{
+    const int NumBlocks = (Length + BlockSize - 1) / BlockSize;
+    const int NumTasks = NumBlocks * NumBlocks;
+    const int Cells = (Length + 1) * (Length + 1);
+    if (!fits_task_deque("smith-waterman", NumTasks))
+    {
+        return false;
+    }
+
+    std::string HostA = random_sequence(Length, 7);
+    std::string HostB = random_sequence(Length, 11);
+    std::vector<int> Reference = serial_smith_waterman(HostA, HostB);
+    std::vector<int> HostH(Cells);
+
+    int *H = sycl::malloc_device<int>(Cells, Q);
+    char *SeqA = sycl::malloc_device<char>(Length, Q);
+    char *SeqB = sycl::malloc_device<char>(Length, Q);
+    Q.memcpy(SeqA, HostA.data(), Length);
+    Q.memcpy(SeqB, HostB.data(), Length);
+    Q.wait();
+
+    WavefrontBody Body{H, SeqA, SeqB, Length, BlockSize, NumBlocks};
+    std::vector<std::vector<int>> SuccessorLists = wavefront_dag(NumBlocks);
+    TaskGraph Graph = make_task_graph(Q, SuccessorLists);
+    LevelSchedule Schedule = make_level_schedule(Q, SuccessorLists);
+    TaskQueueRun Run = make_task_queue_run(Q, graph_roots(SuccessorLists));
+    Run.Overflow = Graph.Overflow;
+
+    bool AllCorrect = true;
+    auto check = [&]()
+    {
+        Q.memcpy(HostH.data(), H, Cells * sizeof(int));
+        Q.wait();
+        bool IsCorrect = HostH == Reference;
+        AllCorrect &= IsCorrect;
+        return IsCorrect;
+    };
+
+    double TaskTime = median_time(Reps, [&]()
+    {
+        Q.fill(H, 0, Cells);
+        reset_task_graph(Q, Graph);
+        reset_task_queue_run(Q, Run, NumTasks);
+    }, [&]()
+    {
+        task_queue_execute(Q, Run, GraphTask<WavefrontBody>{Graph, Body});
+    });
+    if (task_graph_overflowed(Q, Graph))
+    {
+        std::cerr << "smith-waterman task deque overflowed, raise IrDequeCapacity" << "\n";
+        AllCorrect = false;
+    }
+    print_ir_row("smith-waterman", "task-queue", Length, NumTasks, Schedule.num_levels(), TaskTime, check());
+
+    double LevelTime = median_time(Reps, [&]()
+    {
+        Q.fill(H, 0, Cells);
+        Q.wait();
+    }, [&]()
+    {
+        level_sync_execute(Q, Schedule, Body);
+    });
+    print_ir_row("smith-waterman", "level-sync", Length, NumTasks, Schedule.num_levels(), LevelTime, check());
+
+    free_task_queue_run(Q, Run);
+    free_level_schedule(Q, Schedule);
+    free_task_graph(Q, Graph);
+    sycl::free(H, Q);
+    sycl::free(SeqA, Q);
+    sycl::free(SeqB, Q);
+
+    return AllCorrect;
+}
+
+#ifndef IR_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    int Length = 4096;
+    int BlockSize = 64;
+    int Reps = 5;
+    if (argc >= 3)
+    {
+        Length = std::atoi(argv[1]);
+        BlockSize = std::atoi(argv[2]);
+    }
+    if (argc == 4)
+    {
+        Reps = std::atoi(argv[3]);
+    }
+    if (Length <= 0 || BlockSize <= 0 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Sequence Length> <Block Size> [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::queue Q(device_selector);
+    std::cerr << Q.get_device();
+
+    print_ir_header();
+    if (!smith_waterman_bench(Q, Length, BlockSize, Reps))
+    {
+        std::cerr << "Smith-Waterman incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif
+#endif
@@ -0,0 +1,160 @@
+#ifndef _SPMV_CSR_CPP_
+#define _SPMV_CSR_CPP_
+#include "ir_common.cpp"
+#include "../tasking/GrainSize.hpp"
+
+/*
+    y = A x with A in CSR, row lengths following a power law
+    - No dependencies, but the cost per row spans orders of magnitude
+    - Task path: range tasks of RowsPerTask rows, balanced by work-stealing
+    - Baseline: a single level, the flat parallel_for with one row per
+      work-item that a level-synchronous schedule reduces to
+*/
+struct SpmvRowBody
+{
+    const int *RowOffsets;
+    const int *Columns;
+    const float *Values;
+    const float *X;
+    float *Y;
+
+    void operator()(int Row) const
+    {
+        float Sum = 0;
+        for (int e = RowOffsets[Row]; e < RowOffsets[Row + 1]; e++)
+        {
+            Sum += Values[e] * X[Columns[e]];
+        }
+        Y[Row] = Sum;
+    }
+};
+
+std::vector<float> serial_spmv(const HostCsr &Csr, const std::vector<float> &Values, const std::vector<float> &X)
+{
+    std::vector<float> Y(Csr.NumRows);
+    for (int Row = 0; Row < Csr.NumRows; Row++)
+    {
+        float Sum = 0;
+        for (int e = Csr.RowOffsets[Row]; e < Csr.RowOffsets[Row + 1]; e++)
+        {
+            Sum += Values[e] * X[Csr.Columns[e]];
+        }
+        Y[Row] = Sum;
+    }
+    return Y;
+}
+
+bool check_spmv(const std::vector<float> &Y, const std::vector<float> &Reference)
+{
+    for (std::size_t i = 0; i < Y.size(); i++)
+    {
+        if (std::fabs(Y[i] - Reference[i]) > 1e-4f * std::max(1.0f, std::fabs(Reference[i]))) return false;
+    }
+    return true;
+}
+
+bool spmv_bench(sycl::queue &Q, int NumRows, int RowsPerTask, int Reps)
+{
+    HostCsr Csr = power_law_csr(NumRows, NumRows / 8 + 1, 0.8, 3);
+    const int NumEntries = Csr.Columns.size();
+    const int NumTasks = num_range_tasks(NumRows, RowsPerTask);
+
+    std::mt19937 Gen(5);
+    std::uniform_real_distribution<float> Value(-1.0f, 1.0f);
+    std::vector<float> HostValues(NumEntries);
+    std::vector<float> HostX(NumRows);
+    for (float &v : HostValues) v = Value(Gen);
+    for (float &v : HostX) v = Value(Gen);
+
+    std::vector<float> Reference = serial_spmv(Csr, HostValues, HostX);
+    std::vector<float> HostY(NumRows);
+
+    DeviceCsr A = make_device_csr(Q, Csr);
+    float *Values = sycl::malloc_device<float>(NumEntries, Q);
+    float *X = sycl::malloc_device<float>(NumRows, Q);
+    float *Y = sycl::malloc_device<float>(NumRows, Q);
+    Q.memcpy(Values, HostValues.data(), NumEntries * sizeof(float));
+    Q.memcpy(X, HostX.data(), NumRows * sizeof(float));
+    Q.wait();
+
+    SpmvRowBody Body{A.RowOffsets, A.Columns, Values, X, Y};
+    TaskQueueRun Run = make_independent_run(Q, NumTasks);
+
+    bool AllCorrect = true;
+    auto check = [&]()
+    {
+        Q.memcpy(HostY.data(), Y, NumRows * sizeof(float));
+        Q.wait();
+        bool IsCorrect = check_spmv(HostY, Reference);
+        AllCorrect &= IsCorrect;
+        return IsCorrect;
+    };
+
+    double TaskTime = median_time(Reps, [&]()
+    {
+        Q.fill(Y, 0.0f, NumRows);
+        reset_task_queue_run(Q, Run, NumTasks);
+    }, [&]()
+    {
+        task_queue_execute(Q, Run, RangeTask<SpmvRowBody>{{}, Body, NumRows, RowsPerTask});
+    });
+    print_ir_row("spmv", "task-queue", NumRows, NumTasks, 1, TaskTime, check());
+
+    double LevelTime = median_time(Reps, [&]()
+    {
+        Q.fill(Y, 0.0f, NumRows);
+        Q.wait();
+    }, [&]()
+    {
+        Q.parallel_for(NumRows, [=](sycl::id<1> idx)
+        {
+            Body(idx[0]);
+        });
+        Q.wait();
+    });
+    print_ir_row("spmv", "level-sync", NumRows, NumRows, 1, LevelTime, check());
+
+    free_task_queue_run(Q, Run);
+    free_device_csr(Q, A);
+    sycl::free(Values, Q);
+    sycl::free(X, Q);
+    sycl::free(Y, Q);
+
+    return AllCorrect;
+}
+
+#ifndef IR_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    int NumRows = 1 << 18;
+    int RowsPerTask = 16;
+    int Reps = 5;
+    if (argc >= 3)
+    {
+        NumRows = std::atoi(argv[1]);
+        RowsPerTask = std::atoi(argv[2]);
+    }
+    if (argc == 4)
+    {
+        Reps = std::atoi(argv[3]);
+    }
+    if (NumRows <= 0 || RowsPerTask <= 0 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Rows> <Rows per Task> [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::queue Q(device_selector);
+    std::cerr << Q.get_device();
+
+    print_ir_header();
+    if (!spmv_bench(Q, NumRows, RowsPerTask, Reps))
+    {
+        std::cerr << "CSR SpMV incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif
+#endif
@@ -0,0 +1,317 @@
+#ifndef _TILED_CHOLESKY_CPP_
+#define _TILED_CHOLESKY_CPP_
+#include "ir_common.cpp"
+
+/*
+    Tiled Cholesky factorization A = L L^T of an SPD matrix
+    - NumTiles x NumTiles tiles of TileSize x TileSize floats, row-major with
+      leading dimension N = NumTiles * TileSize, only the lower triangle is used
+    - One task per tile kernel (POTRF, TRSM, SYRK, GEMM), executed by a
+      single work-item; step k has 1 POTRF, NumTiles - k - 1 TRSMs and a
+      shrinking trailing update, so the DAG narrows towards its end
+*/
+enum TileKernel
+{
+    Potrf,
+    Trsm,
+    Syrk,
+    Gemm
+};
+
+struct TileOp
+{
+    int Kernel;
+    int I, J; // tile written
+    int K; // step, tile column read
+};
+
+struct CholeskyBody
+{
+    float *A;
+    int N;
+    int TileSize;
+    const TileOp *Ops;
+
+    float *tile(int I, int J) const
+    {
+        return A + (I * TileSize) * N + J * TileSize;
+    }
+
+    void operator()(int TaskId) const
+    {
+        TileOp Op = Ops[TaskId];
+        float *C = tile(Op.I, Op.J);
+        switch (Op.Kernel)
+        {
+            case Potrf:
+                for (int j = 0; j < TileSize; j++)
+                {
+                    float Diag = C[j * N + j];
+                    for (int p = 0; p < j; p++) Diag -= C[j * N + p] * C[j * N + p];
+                    Diag = sycl::sqrt(Diag);
+                    C[j * N + j] = Diag;
+                    for (int i = j + 1; i < TileSize; i++)
+                    {
+                        float Sum = C[i * N + j];
+                        for (int p = 0; p < j; p++) Sum -= C[i * N + p] * C[j * N + p];
+                        C[i * N + j] = Sum / Diag;
+                    }
+                }
+                break;
+            case Trsm:
+            {
+                // C = C * L(K, K)^-T
+                const float *L = tile(Op.K, Op.K);
+                for (int r = 0; r < TileSize; r++)
+                {
+                    for (int j = 0; j < TileSize; j++)
+                    {
+                        float Sum = C[r * N + j];
+                        for (int p = 0; p < j; p++) Sum -= C[r * N + p] * L[j * N + p];
+                        C[r * N + j] = Sum / L[j * N + j];
+                    }
+                }
+                break;
+            }
+            case Syrk:
+            {
+                // C -= L(I, K) * L(I, K)^T, lower half
+                const float *L = tile(Op.I, Op.K);
+                for (int r = 0; r < TileSize; r++)
+                {
+                    for (int c = 0; c <= r; c++)
+                    {
+                        float Sum = 0;
+                        for (int p = 0; p < TileSize; p++) Sum += L[r * N + p] * L[c * N + p];
+                        C[r * N + c] -= Sum;
+                    }
+                }
+                break;
+            }
+            case Gemm:
+            {
+                // C -= L(I, K) * L(J, K)^T
+                const float *Li = tile(Op.I, Op.K);
+                const float *Lj = tile(Op.J, Op.K);
+                for (int r = 0; r < TileSize; r++)
+                {
+                    for (int c = 0; c < TileSize; c++)
+                    {
+                        float Sum = 0;
+                        for (int p = 0; p < TileSize; p++) Sum += Li[r * N + p] * Lj[c * N + p];
+                        C[r * N + c] -= Sum;
+                    }
+                }
+                break;
+            }
+        }
+    }
+};
+
+/*
+    Right-looking tile algorithm, every op depends on the last writer of each
+    tile it reads or writes
+*/
+void cholesky_dag(int NumTiles, std::vector<TileOp> &Ops, std::vector<std::vector<int>> &SuccessorLists)
+{
+    std::vector<int> LastWriter(NumTiles * NumTiles, -1);
+
+    auto add_op = [&](TileOp Op, std::vector<std::pair<int, int>> Reads)
+    {
+        int TaskId = Ops.size();
+        Ops.push_back(Op);
+        SuccessorLists.emplace_back();
+
+        Reads.push_back({Op.I, Op.J});
+        std::vector<int> Predecessors;
+        for (const auto &Tile : Reads)
+        {
+            int Writer = LastWriter[Tile.first * NumTiles + Tile.second];
+            if (Writer >= 0 && std::find(Predecessors.begin(), Predecessors.end(), Writer) == Predecessors.end())
+            {
+                Predecessors.push_back(Writer);
+                SuccessorLists[Writer].push_back(TaskId);
+            }
+        }
+        LastWriter[Op.I * NumTiles + Op.J] = TaskId;
+    };
+
+    for (int k = 0; k < NumTiles; k++)
+    {
+        add_op({Potrf, k, k, k}, {});
+        for (int i = k + 1; i < NumTiles; i++)
+        {
+            add_op({Trsm, i, k, k}, {{k, k}});
+        }
+        for (int i = k + 1; i < NumTiles; i++)
+        {
+            add_op({Syrk, i, i, k}, {{i, k}});
+            for (int j = k + 1; j < i; j++)
+            {
+                add_op({Gemm, i, j, k}, {{i, k}, {j, k}});
+            }
+        }
+    }
+}
+
+/*
+    Diagonally dominant symmetric matrix, hence SPD
+*/
+std::vector<float> spd_matrix(int N, unsigned int Seed)
+{
+    std::mt19937 Gen(Seed);
+    std::uniform_real_distribution<float> Value(0.0f, 1.0f);
+    std::vector<float> A(N * N);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < i; j++)
+        {
+            A[i * N + j] = A[j * N + i] = Value(Gen);
+        }
+        A[i * N + i] = N;
+    }
+    return A;
+}
+
+/*
+    Serial reference, unblocked Cholesky on the lower triangle
+*/
+std::vector<float> serial_cholesky(std::vector<float> A, int N)
+{
+    for (int j = 0; j < N; j++)
+    {
+        float Diag = A[j * N + j];
+        for (int p = 0; p < j; p++) Diag -= A[j * N + p] * A[j * N + p];
+        Diag = std::sqrt(Diag);
+        A[j * N + j] = Diag;
+        for (int i = j + 1; i < N; i++)
+        {
+            float Sum = A[i * N + j];
+            for (int p = 0; p < j; p++) Sum -= A[i * N + p] * A[j * N + p];
+            A[i * N + j] = Sum / Diag;
+        }
+    }
+    return A;
+}
+
+bool check_cholesky(const std::vector<float> &L, const std::vector<float> &Reference, int N)
+{
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j <= i; j++)
+        {
+            float Expected = Reference[i * N + j];
+            if (std::fabs(L[i * N + j] - Expected) > 1e-3f * std::max(1.0f, std::fabs(Expected))) return false;
+        }
+    }
+    return true;
+}
+
+bool cholesky_bench(sycl::queue &Q, int NumTiles, int TileSize, int Reps)
+{
+    const int N = NumTiles * TileSize;
+
+    std::vector<TileOp> HostOps;
+    std::vector<std::vector<int>> SuccessorLists;
+    cholesky_dag(NumTiles, HostOps, SuccessorLists);
+    const int NumTasks = HostOps.size();
+    if (!fits_task_deque("cholesky", NumTasks))
+    {
+        return false;
+    }
+
+    std::vector<float> HostA = spd_matrix(N, 42);
+    std::vector<float> Reference = serial_cholesky(HostA, N);
+    std::vector<float> HostL(N * N);
+
+    TileOp *Ops = sycl::malloc_device<TileOp>(NumTasks, Q);
+    float *A = sycl::malloc_device<float>(N * N, Q);
+    Q.memcpy(Ops, HostOps.data(), NumTasks * sizeof(TileOp));
+    Q.wait();
+
+    CholeskyBody Body{A, N, TileSize, Ops};
+    TaskGraph Graph = make_task_graph(Q, SuccessorLists);
+    LevelSchedule Schedule = make_level_schedule(Q, SuccessorLists);
+    TaskQueueRun Run = make_task_queue_run(Q, graph_roots(SuccessorLists));
+    Run.Overflow = Graph.Overflow;
+
+    bool AllCorrect = true;
+    auto check = [&]()
+    {
+        Q.memcpy(HostL.data(), A, N * N * sizeof(float));
+        Q.wait();
+        bool IsCorrect = check_cholesky(HostL, Reference, N);
+        AllCorrect &= IsCorrect;
+        return IsCorrect;
+    };
+
+    double TaskTime = median_time(Reps, [&]()
+    {
+        Q.memcpy(A, HostA.data(), N * N * sizeof(float));
+        reset_task_graph(Q, Graph);
+        reset_task_queue_run(Q, Run, NumTasks);
+    }, [&]()
+    {
+        task_queue_execute(Q, Run, GraphTask<CholeskyBody>{Graph, Body});
+    });
+    if (task_graph_overflowed(Q, Graph))
+    {
+        std::cerr << "cholesky task deque overflowed, raise IrDequeCapacity" << "\n";
+        AllCorrect = false;
+    }
+    print_ir_row("cholesky", "task-queue", N, NumTasks, Schedule.num_levels(), TaskTime, check());
+
+    double LevelTime = median_time(Reps, [&]()
+    {
+        Q.memcpy(A, HostA.data(), N * N * sizeof(float));
+        Q.wait();
+    }, [&]()
+    {
+        level_sync_execute(Q, Schedule, Body);
+    });
+    print_ir_row("cholesky", "level-sync", N, NumTasks, Schedule.num_levels(), LevelTime, check());
+
+    free_task_queue_run(Q, Run);
+    free_level_schedule(Q, Schedule);
+    free_task_graph(Q, Graph);
+    sycl::free(Ops, Q);
+    sycl::free(A, Q);
+
+    return AllCorrect;
+}
+
+#ifndef IR_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    int NumTiles = 16;
+    int TileSize = 16;
+    int Reps = 5;
+    if (argc >= 3)
+    {
+        NumTiles = std::atoi(argv[1]);
+        TileSize = std::atoi(argv[2]);
+    }
+    if (argc == 4)
+    {
+        Reps = std::atoi(argv[3]);
+    }
+    if (NumTiles <= 0 || TileSize <= 0 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Tiles per dimension> <Tile Size> [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::queue Q(device_selector);
+    std::cerr << Q.get_device();
+
+    print_ir_header();
+    if (!cholesky_bench(Q, NumTiles, TileSize, Reps))
+    {
+        std::cerr << "Tiled Cholesky incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif
+#endif
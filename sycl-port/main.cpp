@@ -1,63 +1,248 @@
-#include "tasking/ArrayQueue.cpp"
 #include <CL/sycl.hpp>
+#include "sycl_utils.hpp"
+#include "tasking/ArrayQueue.cpp"
+#include "tasking/Scheduler.hpp"
+#include "tasking/TaskRecord.hpp"
+#include "vector-add/va_profiler.cpp"
+
+/*
+    Vector add through the persistent scheduler
+    - Each task adds one element
+    - A single kernel launch drains every queue
+*/
+struct AddTask : IndependentTask
+{
+    int *A;
+    int *B;
+    int *R;
 
+    void execute(int TaskId) const
+    {
+        R[TaskId] = A[TaskId] + B[TaskId];
+    }
+};
 
-struct InitData
+template<std::size_t WorkGroupSize>
+bool persistent_add(sycl::queue &Q, const std::size_t VecSize, const std::size_t NumWorkGroups)
 {
-    // Queues, dim size, Mutexes
-}
+    using QueueType = SPMCArrayQueue<int, WorkGroupSize>;
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    auto TaskQueues = sycl::malloc_device<QueueType>(NumWorkGroups, Q);
+
+    int *A = sycl::malloc_device<int>(VecSize, Q);
+    int *B = sycl::malloc_device<int>(VecSize, Q);
+    int *R = sycl::malloc_device<int>(VecSize, Q);
+
+    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    init_task_queues(Q, TaskQueues, NumWorkGroups);
+    Q.wait();
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    InitData<QueueType> Data{TaskQueues, static_cast<int>(NumWorkGroups), static_cast<int>(VecSize)};
+    AddTask Task;
+    Task.A = A;
+    Task.B = B;
+    Task.R = R;
+
+    sycl::event SchedulerEvent = persistent_execute<WorkGroupSize>(Q, Data, Task);
+    Q.wait();
 
+    auto EndTimePoint = std::chrono::high_resolution_clock::now();
 
+    std::vector<int> HostR(VecSize);
+    Q.memcpy(HostR.data(), R, VecSize * sizeof(int));
+    Q.wait();
+    bool CorrectAdd = check_vector_add(HostR.data(), VecSize);
+
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
+
+    auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    std::cout << "Total Exec Time" << "," << ExecTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
+    std::cout << "Memory Setup Time" << "," << MemTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
+    std::cout << "Scheduler Kernel Exec Time" << "," << KernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
+
+    sycl::free(TaskQueues, Q);
+    sycl::free(A, Q);
+    sycl::free(B, Q);
+    sycl::free(R, Q);
+
+    return CorrectAdd;
+}
 
 /*
-FOR NOW JUST CONSIDER HOW THE CODE COULD BE DONE
--- NEED TO BE IN A SYCL ND-RANGE KERNEL
+    Mixed workload through one persistent queue
+    - Every chunk of ChunkSize elements gets an add, a scale and a reduce record
+    - All three kinds run in the same scheduler kernel, picked by opcode
+*/
+struct AddKind
+{
+    struct Args { const int *A; const int *B; int *R; int Begin; int Length; };
+
+    static void execute(const Args &A)
+    {
+        for (int i = A.Begin; i < A.Begin + A.Length; i++)
+        {
+            A.R[i] = A.A[i] + A.B[i];
+        }
+    }
+};
+
+struct ScaleKind
+{
+    struct Args { const int *In; int *Out; int Factor; int Begin; int Length; };
 
->> Get correct task queue
->> Setup initial tasks if master work-item
-group_barrier()
+    static void execute(const Args &A)
+    {
+        for (int i = A.Begin; i < A.Begin + A.Length; i++)
+        {
+            A.Out[i] = A.Factor * A.In[i];
+        }
+    }
+};
 
->> While the queue_size > 0 or the task is not done
-group_barrier
+struct ReduceKind
+{
+    struct Args { const int *In; int *Sum; int Begin; int Length; };
 
-auto ID = Item.get_local_id()
+    static void execute(const Args &A)
+    {
+        int Partial = 0;
+        for (int i = A.Begin; i < A.Begin + A.Length; i++)
+        {
+            Partial += A.In[i];
+        }
+        sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(*A.Sum).fetch_add(Partial);
+    }
+};
+
+using MixedKinds = TaskKinds<AddKind, ScaleKind, ReduceKind>;
 
-// Assumed to be in ND-range
-sycl::group = Item.get_group()
-if (ID == 0) # master
+template<std::size_t WorkGroupSize>
+bool persistent_mixed(sycl::queue &Q, const std::size_t VecSize, const std::size_t NumWorkGroups)
 {
-    initialize queue
-    track queue size
-}
+    using QueueType = SPMCArrayQueue<int, WorkGroupSize>;
+    constexpr int ChunkSize = 256;
+
+    auto TaskQueues = sycl::malloc_device<QueueType>(NumWorkGroups, Q);
 
-sycl::group_barrier(Group)
+    int *A = sycl::malloc_device<int>(VecSize, Q);
+    int *B = sycl::malloc_device<int>(VecSize, Q);
+    int *R = sycl::malloc_device<int>(VecSize, Q);
+    int *S = sycl::malloc_device<int>(VecSize, Q);
+    int *Sum = sycl::malloc_device<int>(1, Q);
 
-while (queue_size > 0 or !Finished(TaskType))
+    std::vector<TaskRecord> HostRecords;
+    for (int Begin = 0; Begin < static_cast<int>(VecSize); Begin += ChunkSize)
+    {
+        int Length = std::min(ChunkSize, static_cast<int>(VecSize) - Begin);
+        HostRecords.push_back(make_task_record<AddKind, MixedKinds>({A, B, R, Begin, Length}));
+        HostRecords.push_back(make_task_record<ScaleKind, MixedKinds>({A, S, 3, Begin, Length}));
+        HostRecords.push_back(make_task_record<ReduceKind, MixedKinds>({A, Sum, Begin, Length}));
+    }
+    auto Records = sycl::malloc_device<TaskRecord>(HostRecords.size(), Q);
+
+    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+        S[idx] = 0;
+    });
+    Q.fill(Sum, 0, 1);
+    Q.memcpy(Records, HostRecords.data(), HostRecords.size() * sizeof(TaskRecord));
+    init_task_queues(Q, TaskQueues, NumWorkGroups);
+    Q.wait();
+
+    InitData<QueueType> Data{TaskQueues, static_cast<int>(NumWorkGroups), static_cast<int>(HostRecords.size())};
+    RecordTask<MixedKinds> Task;
+    Task.Records = Records;
+
+    sycl::event SchedulerEvent = persistent_execute<WorkGroupSize>(Q, Data, Task);
+    Q.wait();
+
+    std::vector<int> HostR(VecSize);
+    std::vector<int> HostS(VecSize);
+    int HostSum = 0;
+    Q.memcpy(HostR.data(), R, VecSize * sizeof(int));
+    Q.memcpy(HostS.data(), S, VecSize * sizeof(int));
+    Q.memcpy(&HostSum, Sum, sizeof(int));
+    Q.wait();
+
+    bool IsCorrect = check_vector_add(HostR.data(), VecSize) && HostSum == static_cast<int>(VecSize);
+    for (std::size_t i = 0; i < VecSize; i++)
+    {
+        if (HostS[i] != 3) IsCorrect = false;
+    }
+
+    auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    std::cout << "Mixed Scheduler Kernel Exec Time" << "," << KernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
+
+    sycl::free(TaskQueues, Q);
+    sycl::free(Records, Q);
+    sycl::free(A, Q);
+    sycl::free(B, Q);
+    sycl::free(R, Q);
+    sycl::free(S, Q);
+    sycl::free(Sum, Q);
+
+    return IsCorrect;
+}
+
+int main(int argc, char **argv)
 {
-    sycl::group_barrier(Group)
-    
-    if (queue_size > ID)
+    std::size_t VecSize = 1 << 20;
+    if (argc == 2)
     {
-        queue->front[ID].execute() # Task
+        VecSize = std::atoi(argv[1]);
     }
+    if (VecSize <= 0) {
+        std::cerr << "Invalid vector size: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+
+    constexpr std::size_t WorkGroupSize = 32;
 
-    sycl::group_barrier(Group)
+    std::size_t NumWorkGroups = Device.get_info<sycl::info::device::max_compute_units>();
+    NumWorkGroups = std::min(NumWorkGroups, (VecSize + WorkGroupSize - 1) / WorkGroupSize);
 
-    # master handles DR
-    if (ID == 0)
+    // Odd sizes and tasks that do not fill a whole round must still be drained
+    bool AllCorrect = true;
+    for (std::size_t Size : {VecSize, VecSize + 7, std::size_t(1)})
     {
-        # number of task done
+        bool CorrectAdd = persistent_add<WorkGroupSize>(Q, Size, NumWorkGroups);
+        if (!CorrectAdd)
+        {
+            std::cerr << "Persistent add incorrect for size: " << Size << "\n";
+            AllCorrect = false;
+        }
 
-        for (int task = 0; task < tasks_done; task++)
+        bool CorrectMixed = persistent_mixed<WorkGroupSize>(Q, Size, NumWorkGroups);
+        if (!CorrectMixed)
         {
-            current_task_id = queue->front(task).get_id()
-            SolveDependencies<TaskType>(current_task_id)
+            std::cerr << "Mixed task records incorrect for size: " << Size << "\n";
+            AllCorrect = false;
         }
-        global_queue->pop(tasks_done)
-        queue_size = global_queue->size();
     }
 
-    sycl::group_barrier(Group)
+    return AllCorrect ? 0 : 1;
 }
-
-*/
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef _SYCL_UTILS_HPP_
 #define _SYCL_UTILS_HPP_
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 #include <CL/sycl.hpp>
 
 namespace sycl
@@ -46,4 +49,23 @@ bool check_vector_add(int *R, size_t VecSize, int NElements = 3)
     // std::cout << std::endl;
     return IsCorrect;
 }
+
+/*
+    Nearest-rank percentile of sorted samples, P in [0, 1]
+*/
+double sorted_percentile(const std::vector<double> &Sorted, double P)
+{
+    std::size_t Rank = static_cast<std::size_t>(std::ceil(P * Sorted.size()));
+    return Sorted[std::max<std::size_t>(Rank, 1) - 1];
+}
+
+/*
+    Median of repeated measurements, the same nearest-rank rule TimingReport
+    uses, so the lower of the two middle samples for an even count
+*/
+double median(std::vector<double> Values)
+{
+    std::sort(Values.begin(), Values.end());
+    return sorted_percentile(Values, 0.5);
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/DeviceBarrier.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Cross-group visibility across DeviceBarrier
+    - Every round each work-item writes a round-stamped value into its
+      group's block with a plain store, waits on the barrier and reads the
+      block of the next group, then waits again before the next round
+      overwrites it
+    - A read that does not see the neighbour's value of the same round means
+      the barrier let a group through early or did not publish the stores;
+      the mismatches are counted on the device
+    - Reports the time per barrier crossing
+*/
+constexpr int Rounds = 1024;
+
+bool barrier_bench(sycl::queue &Q, std::size_t WorkGroupSize)
+{
+    sycl::nd_range<1> Range = persistent_range(Q.get_device(), WorkGroupSize, SIZE_MAX);
+    const int NumGroups = Range.get_group_range()[0];
+    const std::size_t GlobalSize = Range.get_global_range()[0];
+
+    DeviceBarrier *Barrier = sycl::malloc_device<DeviceBarrier>(1, Q);
+    int *Blocks = sycl::malloc_device<int>(GlobalSize, Q);
+    int *Mismatches = sycl::malloc_device<int>(1, Q);
+
+    Q.single_task([=]()
+    {
+        new (Barrier) DeviceBarrier(NumGroups);
+    });
+    Q.fill(Blocks, -1, GlobalSize);
+    Q.fill(Mismatches, 0, 1);
+    Q.wait();
+
+    sycl::event BarrierEvent = Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(Range, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            int GroupIdx = Item.get_group_linear_id();
+            int LocalId = Item.get_local_id(0);
+            int NeighbourIdx = (GroupIdx + 1) % NumGroups;
+
+            int Errors = 0;
+            for (int Round = 0; Round < Rounds; Round++)
+            {
+                Blocks[GroupIdx * WorkGroupSize + LocalId] = Round * NumGroups + GroupIdx;
+
+                Barrier->wait(Group);
+
+                if (Blocks[NeighbourIdx * WorkGroupSize + LocalId] != Round * NumGroups + NeighbourIdx)
+                {
+                    Errors++;
+                }
+
+                Barrier->wait(Group);
+            }
+
+            if (Errors > 0)
+            {
+                sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                    sycl::access::address_space::global_space>(*Mismatches).fetch_add(Errors);
+            }
+        });
+    });
+    Q.wait();
+
+    int HostMismatches = 0;
+    Q.memcpy(&HostMismatches, Mismatches, sizeof(int));
+    Q.wait();
+
+    auto StartKernelExecTimePoint = BarrierEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = BarrierEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    std::cout << WorkGroupSize << "," << NumGroups << "," << KernelProfileTime * 1000.0 / (2 * Rounds) << "," << HostMismatches << "\n";
+
+    sycl::free(Barrier, Q);
+    sycl::free(Blocks, Q);
+    sycl::free(Mismatches, Q);
+
+    return HostMismatches == 0;
+}
+
+int main(int argc, char **argv)
+{
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    std::size_t MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+    if (argc == 2)
+    {
+        MaxGroupSize = std::min<std::size_t>(MaxGroupSize, std::atoi(argv[1]));
+    }
+    if (MaxGroupSize < 32)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Max Work Group Size >= 32]" << "\n";
+        return 1;
+    }
+
+    std::cout << "WorkGroupSize,NumGroups,BarrierTime(us),Mismatches" << "\n";
+
+    bool AllCorrect = true;
+    for (std::size_t WorkGroupSize = 32; WorkGroupSize <= MaxGroupSize; WorkGroupSize *= 2)
+    {
+        AllCorrect &= barrier_bench(Q, WorkGroupSize);
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "A group read stale data across the device barrier!" << "\n";
+        return 1;
+    }
+    return 0;
+}
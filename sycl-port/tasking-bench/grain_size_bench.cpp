@@ -0,0 +1,165 @@
+#include <CL/sycl.hpp>
+#define VA_BENCH_DRIVER
+#include "../sycl_utils.hpp"
+#include "../tasking/ArrayQueue.cpp"
+#include "../tasking/GrainSize.hpp"
+#include "../vector-add/basic-add-usm/vector_add_usm.cpp"
+
+/*
+    Range tasks against the plain parallel_for of vector_add_usm.cpp
+    - Grain 1 is the one-element-per-task scheme of the vector-add variants
+    - The adaptive column uses the grain picked by GrainController, which is
+      calibrated once and then refitted after every run
+    - The crossover is the smallest size from which the adaptive range tasks
+      are no slower than parallel_for
+*/
+constexpr std::size_t WorkGroupSize = 32;
+
+using QueueType = SPMCArrayQueue<int, WorkGroupSize>;
+
+struct AddBody
+{
+    int *A;
+    int *B;
+    int *R;
+
+    void operator()(int Element) const
+    {
+        R[Element] = A[Element] + B[Element];
+    }
+};
+
+double range_add(sycl::queue &Q, QueueType *Queues, int NumQueues, const AddBody &Body, int VecSize, int Grain, bool &IsCorrect)
+{
+    Q.fill(Body.R, 0, VecSize);
+    init_task_queues(Q, Queues, NumQueues);
+    Q.wait();
+
+    sycl::event SchedulerEvent = range_execute<WorkGroupSize>(Q, Queues, NumQueues, VecSize, Grain, Body);
+    Q.wait();
+
+    std::vector<int> HostR(VecSize);
+    Q.memcpy(HostR.data(), Body.R, VecSize * sizeof(int));
+    Q.wait();
+    IsCorrect &= check_vector_add(HostR.data(), VecSize);
+
+    auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    return to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+}
+
+int main(int argc, char **argv)
+{
+    int MaxSize = 1 << 24;
+    int Reps = 5;
+    if (argc >= 2)
+    {
+        MaxSize = std::atoi(argv[1]);
+    }
+    if (argc == 3)
+    {
+        Reps = std::atoi(argv[2]);
+    }
+    if (MaxSize < 1024 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Max Vector Size >= 1024] [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    int NumQueues = Device.get_info<sycl::info::device::max_compute_units>();
+
+    auto Queues = sycl::malloc_device<QueueType>(NumQueues, Q);
+    AddBody Body;
+    Body.A = sycl::malloc_device<int>(MaxSize, Q);
+    Body.B = sycl::malloc_device<int>(MaxSize, Q);
+    Body.R = sycl::malloc_device<int>(MaxSize, Q);
+    Q.fill(Body.A, 1, MaxSize);
+    Q.fill(Body.B, 0, MaxSize);
+    Q.wait();
+
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(MaxSize) + verify_footprint());
+
+    bool IsCorrect = true;
+
+    // Calibration: one run with a task per element, one with the coarsest grain
+    GrainController Controller(NumQueues * WorkGroupSize);
+    for (int Grain : {1, Controller.grain(MaxSize)})
+    {
+        Controller.record(MaxSize, Grain, range_add(Q, Queues, NumQueues, Body, MaxSize, Grain, IsCorrect));
+    }
+
+    std::cout << "VectorSize,Usm(ms),Grain1(ms),Adaptive(ms),Grain,TaskOverhead(us),ElementCost(ns)" << "\n";
+
+    int Crossover = -1;
+    try
+    {
+        for (int VecSize = 1024; VecSize <= MaxSize; VecSize *= 2)
+        {
+            std::vector<double> UsmTimes, Grain1Times, AdaptiveTimes;
+            int Grain = Controller.grain(VecSize);
+
+            for (int Rep = 0; Rep < Reps; Rep++)
+            {
+                std::vector<TimingEvent> Events;
+                IsCorrect &= basic_usm_add(Q, Arena, VecSize, Events);
+                for (const TimingEvent &Event : Events)
+                {
+                    if (Event.Name == "Kernel Exec Time") UsmTimes.push_back(Event.ExecTime);
+                }
+
+                Grain1Times.push_back(range_add(Q, Queues, NumQueues, Body, VecSize, 1, IsCorrect));
+
+                double AdaptiveTime = range_add(Q, Queues, NumQueues, Body, VecSize, Grain, IsCorrect);
+                AdaptiveTimes.push_back(AdaptiveTime);
+                Controller.record(VecSize, Grain, AdaptiveTime);
+            }
+
+            double UsmTime = median(UsmTimes);
+            double AdaptiveTime = median(AdaptiveTimes);
+            if (AdaptiveTime > UsmTime)
+            {
+                Crossover = -1;
+            }
+            else if (Crossover < 0)
+            {
+                Crossover = VecSize;
+            }
+
+            std::cout << VecSize << "," << UsmTime << "," << median(Grain1Times) << "," << AdaptiveTime << "," << Grain << ","
+                      << Controller.task_overhead() * 1e3 << "," << Controller.element_cost() * 1e6 << "\n";
+        }
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    if (Crossover > 0)
+    {
+        std::cerr << "Range tasks match parallel_for from vector size " << Crossover << " on" << "\n";
+    }
+    else
+    {
+        std::cerr << "Range tasks stay slower than parallel_for up to vector size " << MaxSize << "\n";
+    }
+
+    sycl::free(Queues, Q);
+    sycl::free(Body.A, Q);
+    sycl::free(Body.B, Q);
+    sycl::free(Body.R, Q);
+
+    if (!IsCorrect)
+    {
+        std::cerr << "Range task vector add incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
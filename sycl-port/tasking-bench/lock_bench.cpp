@@ -0,0 +1,148 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/Mutex.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Lock contention microbenchmark
+    - NumContenders work-groups each take the lock AcquiresPerContender times
+      and bump a plain (non-atomic) counter inside the critical section
+    - Work-item locks run with one work-item per group (see Mutex.hpp on lockstep lanes)
+    - GroupLock runs WorkGroupSize work-items per group, every work-item counts
+      as one acquisition but only the leader touches the lock
+    - The final counter doubles as a mutual exclusion check
+*/
+constexpr int AcquiresPerContender = 256;
+constexpr std::size_t GroupLockSize = 32;
+
+double report(sycl::event &LockEvent, const std::string &Name, std::size_t Acquisitions, std::size_t NumContenders)
+{
+    auto StartKernelExecTimePoint = LockEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = LockEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+    double AcquisitionsPerSec = Acquisitions / (KernelProfileTime / 1000.0);
+
+    std::cout << Name << "," << AcquisitionsPerSec << "," << NumContenders << "\n";
+    return AcquisitionsPerSec;
+}
+
+template<typename LockType>
+bool item_lock_bench(sycl::queue &Q, const std::string &Name, std::size_t NumContenders)
+{
+    LockType *Lock = sycl::malloc_device<LockType>(1, Q);
+    int *Counter = sycl::malloc_device<int>(1, Q);
+
+    Q.single_task([=]()
+    {
+        new (Lock) LockType();
+        *Counter = 0;
+    });
+    Q.wait();
+
+    sycl::event LockEvent = Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{NumContenders}, sycl::range<1>{1}}, [=](sycl::nd_item<1> Item)
+        {
+            for (int i = 0; i < AcquiresPerContender; i++)
+            {
+                Lock->lock();
+                *Counter += 1;
+                Lock->unlock();
+            }
+        });
+    });
+    Q.wait();
+
+    int HostCounter;
+    Q.memcpy(&HostCounter, Counter, sizeof(int));
+    Q.wait();
+
+    std::size_t Acquisitions = NumContenders * AcquiresPerContender;
+    report(LockEvent, Name, Acquisitions, NumContenders);
+
+    sycl::free(Lock, Q);
+    sycl::free(Counter, Q);
+
+    return HostCounter == static_cast<int>(Acquisitions);
+}
+
+template<typename LockType>
+bool group_lock_bench(sycl::queue &Q, const std::string &Name, std::size_t NumContenders)
+{
+    using GroupLockType = GroupLock<LockType>;
+    GroupLockType *Lock = sycl::malloc_device<GroupLockType>(1, Q);
+    int *Counter = sycl::malloc_device<int>(1, Q);
+
+    Q.single_task([=]()
+    {
+        new (Lock) GroupLockType();
+        *Counter = 0;
+    });
+    Q.wait();
+
+    sycl::event LockEvent = Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{NumContenders * GroupLockSize}, sycl::range<1>{GroupLockSize}}, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            for (int i = 0; i < AcquiresPerContender; i++)
+            {
+                Lock->lock(Group);
+                // Every work-item's increment, applied once by the leader
+                int GroupIncrement = sycl::reduce_over_group(Group, 1, sycl::plus<int>());
+                if (Group.leader())
+                {
+                    *Counter += GroupIncrement;
+                }
+                Lock->unlock(Group);
+            }
+        });
+    });
+    Q.wait();
+
+    int HostCounter;
+    Q.memcpy(&HostCounter, Counter, sizeof(int));
+    Q.wait();
+
+    std::size_t Acquisitions = NumContenders * GroupLockSize * AcquiresPerContender;
+    report(LockEvent, Name, Acquisitions, NumContenders);
+
+    sycl::free(Lock, Q);
+    sycl::free(Counter, Q);
+
+    return HostCounter == static_cast<int>(Acquisitions);
+}
+
+int main(int argc, char **argv)
+{
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    std::size_t MaxContenders = 2 * Device.get_info<sycl::info::device::max_compute_units>();
+    if (argc == 2)
+    {
+        MaxContenders = std::atoi(argv[1]);
+    }
+
+    std::cout << "Lock,Acquisitions/s,NumContenders" << "\n";
+
+    bool AllCorrect = true;
+    for (std::size_t NumContenders = 1; NumContenders <= MaxContenders; NumContenders *= 2)
+    {
+        AllCorrect &= item_lock_bench<Mutex>(Q, "TAS Mutex", NumContenders);
+        AllCorrect &= item_lock_bench<TicketLock>(Q, "Ticket", NumContenders);
+        AllCorrect &= item_lock_bench<BackoffLock<>>(Q, "Backoff TTAS", NumContenders);
+        AllCorrect &= group_lock_bench<BackoffLock<>>(Q, "Group Backoff TTAS", NumContenders);
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Mutual exclusion violated!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/MPMCQueue.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Contention stress test and throughput benchmark for MPMCArrayQueue
+    - Every work-item interleaves try_push/try_pop on one shared queue
+    - Each pushed value is unique, so after draining the queue every value
+      that was pushed must have been popped exactly once
+*/
+constexpr unsigned int QueueCapacity = 1 << 16;
+constexpr int OpsPerItem = 64;
+
+using QueueType = MPMCArrayQueue<int, QueueCapacity>;
+
+bool mpmc_stress(sycl::queue &Q, QueueType *TaskQueue, const std::size_t NumThreads)
+{
+    const std::size_t NumValues = NumThreads * OpsPerItem;
+
+    int *Pushed = sycl::malloc_device<int>(NumValues, Q);
+    int *Seen = sycl::malloc_device<int>(NumValues, Q);
+    unsigned long long *OpCount = sycl::malloc_device<unsigned long long>(1, Q);
+
+    Q.single_task([=]()
+    {
+        new (TaskQueue) QueueType();
+        *OpCount = 0;
+    });
+    Q.fill(Pushed, 0, NumValues);
+    Q.fill(Seen, 0, NumValues);
+    Q.wait();
+
+    sycl::event StressEvent = Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(NumThreads, [=](sycl::id<1> idx)
+        {
+            // Never spin on the queue: a lane waiting on a lane of the same
+            // work-group can deadlock when work-items run in lockstep
+            unsigned long long Ops = 0;
+            for (int k = 0; k < OpsPerItem; k++)
+            {
+                int Value = idx[0] * OpsPerItem + k;
+                if (TaskQueue->try_push(Value))
+                {
+                    Pushed[Value] = 1;
+                    Ops++;
+                }
+
+                int Popped;
+                if (TaskQueue->try_pop(Popped))
+                {
+                    sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                        sycl::access::address_space::global_space>(Seen[Popped]).fetch_add(1);
+                    Ops++;
+                }
+            }
+            sycl::atomic_ref<unsigned long long, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                sycl::access::address_space::global_space>(*OpCount).fetch_add(Ops);
+        });
+    });
+    Q.wait();
+
+    Q.single_task([=]()
+    {
+        int Popped;
+        while (TaskQueue->try_pop(Popped))
+        {
+            Seen[Popped] += 1;
+        }
+    });
+    Q.wait();
+
+    std::vector<int> HostPushed(NumValues);
+    std::vector<int> HostSeen(NumValues);
+    unsigned long long HostOpCount;
+    Q.memcpy(HostPushed.data(), Pushed, NumValues * sizeof(int));
+    Q.memcpy(HostSeen.data(), Seen, NumValues * sizeof(int));
+    Q.memcpy(&HostOpCount, OpCount, sizeof(unsigned long long));
+    Q.wait();
+
+    bool IsCorrect = true;
+    for (std::size_t i = 0; i < NumValues; i++)
+    {
+        if (HostPushed[i] != HostSeen[i]) IsCorrect = false;
+    }
+
+    auto StartKernelExecTimePoint = StressEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = StressEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+    double OpsPerSec = HostOpCount / (KernelProfileTime / 1000.0);
+
+    std::cout << "Stress Kernel Exec Time" << "," << KernelProfileTime << "," << NumThreads << "\n";
+    std::cout << "Throughput (ops/s)" << "," << OpsPerSec << "," << NumThreads << "\n";
+
+    sycl::free(Pushed, Q);
+    sycl::free(Seen, Q);
+    sycl::free(OpCount, Q);
+
+    return IsCorrect;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t MaxThreads = 1 << 14;
+    if (argc == 2)
+    {
+        MaxThreads = std::atoi(argv[1]);
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    std::cerr << Q.get_device();
+
+    auto TaskQueue = sycl::malloc_device<QueueType>(1, Q);
+
+    std::cout << "Event,Value,NumThreads" << "\n";
+
+    bool AllCorrect = true;
+    for (std::size_t NumThreads = 1; NumThreads <= MaxThreads; NumThreads *= 2)
+    {
+        if (!mpmc_stress(Q, TaskQueue, NumThreads))
+        {
+            std::cerr << "Lost or duplicated elements with " << NumThreads << " threads!" << "\n";
+            AllCorrect = false;
+        }
+    }
+
+    sycl::free(TaskQueue, Q);
+
+    return AllCorrect ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/ArrayQueue.cpp"
+#include "../tasking/MultiDevice.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Vector add over one device versus a partitioned device (or several devices)
+    - Each (sub-)device has its own sycl::queue and task queues
+    - Each device first-touches its own block of the vectors, the
+      coordinator keeps it on that block until it runs dry
+    - The vectors are shared USM for one device and host USM for several,
+      see malloc_all_devices
+*/
+constexpr std::size_t WorkGroupSize = 32;
+
+using QueueType = SPMCArrayQueue<int, WorkGroupSize>;
+
+struct AddTask : IndependentTask
+{
+    int *A;
+    int *B;
+    int *R;
+
+    void execute(int TaskId) const
+    {
+        R[TaskId] = A[TaskId] + B[TaskId];
+    }
+};
+
+bool multi_device_add(const std::vector<sycl::device> &Devices, const std::string &Label, const std::size_t VecSize, const int ChunkSize)
+{
+    sycl::context Context(Devices);
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    std::vector<sycl::queue> Queues;
+    std::vector<QueueType *> TaskQueues;
+    std::vector<std::size_t> NumWorkGroups;
+    for (const sycl::device &Device : Devices)
+    {
+        Queues.emplace_back(Context, Device, props);
+
+        std::size_t Groups = Device.get_info<sycl::info::device::max_compute_units>();
+        NumWorkGroups.push_back(Groups);
+        TaskQueues.push_back(sycl::malloc_device<QueueType>(Groups, Queues.back()));
+        init_task_queues(Queues.back(), TaskQueues.back(), Groups);
+    }
+
+    DeviceCoordinator Coordinator(VecSize, Devices.size(), ChunkSize);
+
+    AddTask Task;
+    Task.A = malloc_all_devices<int>(VecSize, Context, Devices);
+    Task.B = malloc_all_devices<int>(VecSize, Context, Devices);
+    Task.R = malloc_all_devices<int>(VecSize, Context, Devices);
+    if (Task.A == nullptr || Task.B == nullptr || Task.R == nullptr)
+    {
+        std::cerr << Label << ": no USM kind is accessible from all " << Devices.size() << " devices" << "\n";
+        sycl::free(Task.A, Context);
+        sycl::free(Task.B, Context);
+        sycl::free(Task.R, Context);
+        for (std::size_t d = 0; d < Devices.size(); d++)
+        {
+            sycl::free(TaskQueues[d], Queues[d]);
+        }
+        return false;
+    }
+
+    for (std::size_t d = 0; d < Devices.size(); d++)
+    {
+        std::size_t Begin = Coordinator.block_begin(d);
+        std::size_t End = d + 1 < Devices.size() ? Coordinator.block_begin(d + 1) : VecSize;
+        int *A = Task.A + Begin;
+        int *B = Task.B + Begin;
+        int *R = Task.R + Begin;
+        if (End > Begin)
+        {
+            Queues[d].parallel_for(End - Begin, [=](sycl::id<1> idx) {
+                A[idx] = 1;
+                B[idx] = 0;
+                R[idx] = 0;
+            });
+        }
+    }
+    for (sycl::queue &Q : Queues)
+    {
+        Q.wait();
+    }
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    multi_device_execute<WorkGroupSize>(Queues, TaskQueues, NumWorkGroups, Coordinator, Task);
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now();
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+
+    bool IsCorrect = check_vector_add(Task.R, VecSize);
+
+    int Stolen = 0;
+    for (std::size_t d = 0; d < Devices.size(); d++)
+    {
+        Stolen += Coordinator.stolen(d);
+    }
+
+    std::cout << Label << "," << Devices.size() << "," << VecSize << "," << ChunkSize << "," << ExecTime.count() << "," << Stolen << "\n";
+
+    sycl::free(Task.A, Context);
+    sycl::free(Task.B, Context);
+    sycl::free(Task.R, Context);
+    for (std::size_t d = 0; d < Devices.size(); d++)
+    {
+        sycl::free(TaskQueues[d], Queues[d]);
+    }
+
+    return IsCorrect;
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t VecSize = 1 << 24;
+    std::string Mode = "numa";
+    if (argc >= 2)
+    {
+        VecSize = std::atoi(argv[1]);
+    }
+    if (argc == 3)
+    {
+        Mode = argv[2];
+    }
+    if (VecSize <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Vector Size] [numa|equal:<Compute Units>|all]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::device Root(device_selector);
+    std::cerr << Root;
+
+    std::vector<sycl::device> Partitions = partition_device(Root, Mode);
+    std::cerr << "Partitions (" << Mode << "): " << Partitions.size() << "\n";
+
+    std::cout << "Mode,Devices,VectorSize,ChunkSize,ExecTime(ms),StolenTasks" << "\n";
+
+    bool AllCorrect = true;
+    for (int ChunkSize : {1 << 14, 1 << 18})
+    {
+        AllCorrect &= multi_device_add({Root}, "single", VecSize, ChunkSize);
+        AllCorrect &= multi_device_add(Partitions, Mode, VecSize, ChunkSize);
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Multi-device vector add incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <CL/sycl.hpp>
+#include <functional>
+#define VA_BENCH_DRIVER
+#include "../sycl_utils.hpp"
+#include "../vector-add/gsq-add/vector_add_gsq.cpp"
+#include "../vector-add/split-kernel-multiQ-add/vector_add_split_gmq.cpp"
+
+/*
+    Throughput of a stream of small batches, host-synchronised after every
+    phase versus chained with depends_on and a single final wait
+    - The vector size is fixed, the batch size shrinks so the number of
+      batches (and of host round trips in the synchronised mode) grows
+    - The default queue is out-of-order, ordering comes from the events only
+*/
+constexpr std::size_t WorkGroupSize = 128;
+
+using BatchedRun = std::function<bool(sycl::queue &, DeviceArena &, std::size_t, std::size_t, bool, std::vector<TimingEvent> &)>;
+
+/*
+    Clears AllCorrect if any repetition produced a wrong result
+*/
+double median_stream_time(sycl::queue &Q, DeviceArena &Arena, const BatchedRun &Run, std::size_t VecSize, std::size_t BatchSize, bool Pipelined, int Reps,
+    bool &AllCorrect)
+{
+    std::vector<double> Times;
+    for (int Rep = 0; Rep < Reps; Rep++)
+    {
+        std::vector<TimingEvent> Events;
+        AllCorrect &= Run(Q, Arena, VecSize, BatchSize, Pipelined, Events);
+        for (const TimingEvent &Event : Events)
+        {
+            if (Event.Name == "Batch Stream Time") Times.push_back(Event.ExecTime);
+        }
+    }
+    return median(Times);
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t VecSize = 1 << 20;
+    int Reps = 5;
+    if (argc >= 2)
+    {
+        VecSize = std::atoi(argv[1]);
+    }
+    if (argc == 3)
+    {
+        Reps = std::atoi(argv[2]);
+    }
+    if (VecSize < WorkGroupSize || VecSize % WorkGroupSize != 0 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Vector Size, multiple of " << WorkGroupSize << "] [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    // Two queue sets in flight at most, sized for the largest batch
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(VecSize)
+                         + std::max(ring_queues_footprint<int>(2, VecSize), ring_queues_footprint<int>(2 * VecSize / WorkGroupSize, WorkGroupSize))
+                         + verify_footprint());
+
+    std::vector<std::pair<std::string, BatchedRun>> Variants{
+        {"gsq", [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t BatchSize, bool Pipelined, std::vector<TimingEvent> &Events)
+            { return single_queue_batched_add(Q, Arena, VecSize, BatchSize, Pipelined, Events); }},
+        {"split", [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t BatchSize, bool Pipelined, std::vector<TimingEvent> &Events)
+            { return split_kernel_batched_add(Q, Arena, VecSize, WorkGroupSize, BatchSize, Pipelined, Events); }},
+    };
+
+    std::cout << "Variant,VectorSize,BatchSize,Batches,Sync(ms),Pipelined(ms),Sync(Elements/s),Pipelined(Elements/s),Gain" << "\n";
+
+    bool AllCorrect = true;
+    try
+    {
+        for (const auto &Variant : Variants)
+        {
+            for (std::size_t BatchSize = VecSize; BatchSize >= WorkGroupSize && BatchSize % WorkGroupSize == 0; BatchSize /= 4)
+            {
+                double SyncTime = median_stream_time(Q, Arena, Variant.second, VecSize, BatchSize, false, Reps, AllCorrect);
+                double PipelinedTime = median_stream_time(Q, Arena, Variant.second, VecSize, BatchSize, true, Reps, AllCorrect);
+
+                std::cout << Variant.first << "," << VecSize << "," << BatchSize << "," << (VecSize + BatchSize - 1) / BatchSize << ","
+                          << SyncTime << "," << PipelinedTime << ","
+                          << VecSize / (SyncTime * 1e-3) << "," << VecSize / (PipelinedTime * 1e-3) << ","
+                          << SyncTime / PipelinedTime << "\n";
+            }
+        }
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "At least one batched run produced a wrong result!" << "\n";
+        return 1;
+    }
+    return 0;
+}
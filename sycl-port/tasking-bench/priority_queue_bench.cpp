@@ -0,0 +1,196 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/ArrayQueue.cpp"
+#include "../tasking/BucketQueue.hpp"
+#include "../tasking/Scheduler.hpp"
+#include "../tasking/TaskGraph.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Makespan of a DAG with a long critical path, FIFO versus bucketed
+    priority queues in the same persistent_execute loop
+    - Every work-group starts with ChainLength rounds of independent bulk
+      tasks; the head of a ChainLength long chain is the last initial task
+      of the last group
+    - FIFO runs the chain only after that group's bulk, about
+      2 * ChainLength rounds; keyed by bottom level the chain advances
+      every round next to the bulk, about ChainLength rounds; every chain
+      task but the last sits above the bulk's bottom level, so none of them
+      shares bucket 0 with it
+*/
+constexpr int QueueCapacity = 1 << 12;
+constexpr std::size_t WorkGroupSize = 32;
+
+using FifoQueueType = SPMCArrayQueue<int, QueueCapacity>;
+using PriorityQueueType = SPMCBucketQueue<int, QueueCapacity, WorkGroupSize>;
+
+struct WorkBody
+{
+    float *Out;
+    int *Stamp;
+    int *Clock;
+    int Iters;
+
+    void operator()(int TaskId) const
+    {
+        float Acc = TaskId;
+        for (int i = 0; i < Iters; i++)
+        {
+            Acc = Acc * 0.999f + 1.0f;
+        }
+        Out[TaskId] = Acc;
+        Stamp[TaskId] = sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(*Clock).fetch_add(1);
+    }
+};
+
+/*
+    Tasks 0..NumRoots-1 are the initial tasks, NumRoots-1 being the chain head,
+    the rest of the chain follows
+*/
+std::vector<std::vector<int>> critical_path_dag(int NumRoots, int ChainLength)
+{
+    std::vector<std::vector<int>> SuccessorLists(NumRoots + ChainLength - 1);
+    int Previous = NumRoots - 1;
+    for (int k = 1; k < ChainLength; k++)
+    {
+        SuccessorLists[Previous].push_back(NumRoots + k - 1);
+        Previous = NumRoots + k - 1;
+    }
+    return SuccessorLists;
+}
+
+/*
+    Every task ran exactly once and after all of its predecessors
+*/
+bool check_schedule(const std::vector<std::vector<int>> &SuccessorLists, const std::vector<int> &Stamp)
+{
+    std::vector<int> Seen(Stamp.size(), 0);
+    for (int s : Stamp)
+    {
+        if (s < 0 || s >= static_cast<int>(Stamp.size()) || Seen[s]++) return false;
+    }
+    for (std::size_t i = 0; i < SuccessorLists.size(); i++)
+    {
+        for (int Successor : SuccessorLists[i])
+        {
+            if (Stamp[i] >= Stamp[Successor]) return false;
+        }
+    }
+    return true;
+}
+
+template<typename QueueType, typename InitType>
+double makespan(sycl::queue &Q, QueueType *Queues, int NumQueues, int NumRoots, const TaskGraph &Graph, const WorkBody &Body,
+    InitType InitQueues, int Reps)
+{
+    std::vector<double> Times;
+    for (int Rep = 0; Rep < Reps; Rep++)
+    {
+        InitQueues();
+        reset_task_graph(Q, Graph);
+        Q.fill(Body.Stamp, -1, Graph.NumTasks);
+        Q.fill(Body.Clock, 0, 1);
+        Q.wait();
+
+        InitData<QueueType> Data{Queues, NumQueues, NumRoots};
+        sycl::event SchedulerEvent = persistent_execute<WorkGroupSize>(Q, Data, GraphTask<WorkBody>{Graph, Body});
+        Q.wait();
+
+        auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+        auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+        Times.push_back(to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint));
+    }
+    return median(Times);
+}
+
+int main(int argc, char **argv)
+{
+    int ChainLength = 64;
+    int Iters = 1024;
+    int Reps = 5;
+    if (argc >= 2)
+    {
+        ChainLength = std::atoi(argv[1]);
+    }
+    if (argc == 3)
+    {
+        Reps = std::atoi(argv[2]);
+    }
+    if (ChainLength <= 0 || ChainLength * static_cast<int>(WorkGroupSize) > QueueCapacity || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Chain Length <= " << QueueCapacity / WorkGroupSize << "] [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    int NumQueues = Device.get_info<sycl::info::device::max_compute_units>();
+
+    // ChainLength full rounds of initial tasks per group, the chain head included
+    const int NumRoots = NumQueues * ChainLength * WorkGroupSize;
+    auto SuccessorLists = critical_path_dag(NumRoots, ChainLength);
+    const int NumTasks = SuccessorLists.size();
+    TaskGraph Graph = make_task_graph(Q, SuccessorLists);
+
+    std::vector<int> HostLevels = bottom_levels(SuccessorLists);
+    int MinLevel = *std::min_element(HostLevels.begin(), HostLevels.end());
+    int MaxLevel = *std::max_element(HostLevels.begin(), HostLevels.end());
+    int *Levels = sycl::malloc_device<int>(NumTasks, Q);
+    Q.memcpy(Levels, HostLevels.data(), NumTasks * sizeof(int));
+
+    float *Out = sycl::malloc_device<float>(NumTasks, Q);
+    int *Stamp = sycl::malloc_device<int>(NumTasks, Q);
+    int *Clock = sycl::malloc_device<int>(1, Q);
+    WorkBody Body{Out, Stamp, Clock, Iters};
+
+    auto FifoQueues = sycl::malloc_device<FifoQueueType>(NumQueues, Q);
+    auto PriorityQueues = sycl::malloc_device<PriorityQueueType>(NumQueues, Q);
+    Q.wait();
+
+    std::vector<int> HostStamp(NumTasks);
+    bool AllCorrect = true;
+    auto check = [&]()
+    {
+        Q.memcpy(HostStamp.data(), Stamp, NumTasks * sizeof(int));
+        Q.wait();
+        AllCorrect &= check_schedule(SuccessorLists, HostStamp);
+    };
+
+    double FifoTime = makespan(Q, FifoQueues, NumQueues, NumRoots, Graph, Body, [&]()
+    {
+        init_task_queues(Q, FifoQueues, NumQueues);
+    }, Reps);
+    check();
+
+    double PriorityTime = makespan(Q, PriorityQueues, NumQueues, NumRoots, Graph, Body, [&]()
+    {
+        init_priority_queues(Q, PriorityQueues, NumQueues, Levels, MinLevel, MaxLevel);
+    }, Reps);
+    check();
+
+    std::cout << "Queue,Makespan(ms),NumTasks,CriticalPath" << "\n";
+    std::cout << "fifo" << "," << FifoTime << "," << NumTasks << "," << MaxLevel << "\n";
+    std::cout << "priority" << "," << PriorityTime << "," << NumTasks << "," << MaxLevel << "\n";
+    std::cerr << "Priority speedup: " << FifoTime / PriorityTime << "\n";
+
+    sycl::free(FifoQueues, Q);
+    sycl::free(PriorityQueues, Q);
+    sycl::free(Levels, Q);
+    sycl::free(Out, Q);
+    sycl::free(Stamp, Q);
+    sycl::free(Clock, Q);
+    free_task_graph(Q, Graph);
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Dependency order violated!" << "\n";
+        return 1;
+    }
+    return 0;
+}
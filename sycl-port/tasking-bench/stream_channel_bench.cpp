@@ -0,0 +1,197 @@
+#include <CL/sycl.hpp>
+#include <cmath>
+#include <numeric>
+#include <thread>
+#include "../sycl_utils.hpp"
+#include "../tasking/StreamChannel.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Host threads stream tasks into a running consumer kernel
+    - Latency: from the moment a task is published to the moment the host sees
+      its completion flag (the collector scans the flags in task order, so
+      this is an upper bound)
+    - Throughput: tasks per second from the first publish to the last completion
+    - IntervalUs paces every producer, 0 pushes as fast as the channel allows
+    - Every task counts its executions, a run fails if any count is not
+      exactly one or if no task completes for StallTimeout (a lost task)
+*/
+constexpr int ChannelCapacity = 1 << 12;
+constexpr std::size_t WorkGroupSize = 32;
+
+using ChannelType = StreamChannel<int, ChannelCapacity>;
+using TimePoint = std::chrono::high_resolution_clock::time_point;
+
+constexpr std::chrono::seconds StallTimeout(10);
+
+struct FlagTask
+{
+    int *Executions;
+    int *Done;
+
+    void execute(int TaskId) const
+    {
+        sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device>(Executions[TaskId]).fetch_add(1);
+        sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::system>(Done[TaskId]).store(1, sycl::memory_order::release);
+    }
+};
+
+bool stream_run(sycl::queue &Q, std::size_t NumWorkGroups, int NumTasks, int NumProducers, int IntervalUs)
+{
+    auto Channel = sycl::malloc_shared<ChannelType>(1, Q);
+    new (Channel) ChannelType();
+    int *Executions = sycl::malloc_shared<int>(NumTasks, Q);
+    int *Done = sycl::malloc_shared<int>(NumTasks, Q);
+    std::fill(Executions, Executions + NumTasks, 0);
+    std::fill(Done, Done + NumTasks, 0);
+
+    FlagTask Task;
+    Task.Executions = Executions;
+    Task.Done = Done;
+
+    std::vector<TimePoint> PublishTime(NumTasks);
+    std::vector<TimePoint> DoneTime(NumTasks);
+
+    sycl::event ConsumerEvent = stream_execute<WorkGroupSize>(Q, Channel, NumWorkGroups, Task);
+
+    std::vector<std::thread> Producers;
+    for (int p = 0; p < NumProducers; p++)
+    {
+        Producers.emplace_back([=, &PublishTime]()
+        {
+            for (int TaskId = p; TaskId < NumTasks; TaskId += NumProducers)
+            {
+                if (IntervalUs > 0)
+                {
+                    auto Until = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(IntervalUs);
+                    while (std::chrono::high_resolution_clock::now() < Until)
+                    {
+                    }
+                }
+                // stamped before the push, a consumer may finish the task before push returns
+                PublishTime[TaskId] = std::chrono::high_resolution_clock::now();
+                Channel->push(TaskId);
+            }
+        });
+    }
+
+    // A lost task never sets its flag, give up once nothing completes for StallTimeout
+    bool Stalled = false;
+    TimePoint Deadline = std::chrono::high_resolution_clock::now() + StallTimeout;
+    for (int TaskId = 0; TaskId < NumTasks && !Stalled; TaskId++)
+    {
+        sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::system> Flag(Done[TaskId]);
+        while (Flag.load(sycl::memory_order::acquire) == 0)
+        {
+            if (std::chrono::high_resolution_clock::now() > Deadline)
+            {
+                Stalled = true;
+                break;
+            }
+        }
+        DoneTime[TaskId] = std::chrono::high_resolution_clock::now();
+        Deadline = DoneTime[TaskId] + StallTimeout;
+    }
+
+    for (std::thread &Producer : Producers)
+    {
+        Producer.join();
+    }
+    Channel->close();
+    ConsumerEvent.wait();
+
+    bool IsCorrect = true;
+    for (int i = 0; i < NumTasks; i++)
+    {
+        if (Executions[i] == 0)
+        {
+            std::cerr << "Task " << i << " was lost" << "\n";
+            IsCorrect = false;
+        }
+        else if (Executions[i] != 1)
+        {
+            std::cerr << "Task " << i << " executed " << Executions[i] << " times" << "\n";
+            IsCorrect = false;
+        }
+    }
+    if (Stalled)
+    {
+        std::cerr << "No task completed for " << StallTimeout.count() << " s, "
+                  << NumProducers << " producers, interval " << IntervalUs << " us" << "\n";
+        IsCorrect = false;
+    }
+
+    std::vector<double> Latencies(NumTasks);
+    TimePoint FirstPublish = PublishTime[0];
+    TimePoint LastDone = DoneTime[0];
+    for (int i = 0; i < NumTasks && IsCorrect; i++)
+    {
+        Latencies[i] = std::chrono::duration<double, std::micro>(DoneTime[i] - PublishTime[i]).count();
+        FirstPublish = std::min(FirstPublish, PublishTime[i]);
+        LastDone = std::max(LastDone, DoneTime[i]);
+    }
+
+    if (IsCorrect)
+    {
+        double Seconds = std::chrono::duration<double>(LastDone - FirstPublish).count();
+        double MeanLatency = std::accumulate(Latencies.begin(), Latencies.end(), 0.0) / NumTasks;
+        std::sort(Latencies.begin(), Latencies.end());
+
+        std::cout << NumProducers << "," << IntervalUs << "," << NumTasks << "," << NumWorkGroups << ","
+                  << NumTasks / Seconds << "," << MeanLatency << "," << sorted_percentile(Latencies, 0.5) << ","
+                  << sorted_percentile(Latencies, 0.99) << "\n";
+    }
+
+    Channel->~ChannelType();
+    sycl::free(Channel, Q);
+    sycl::free(Executions, Q);
+    sycl::free(Done, Q);
+
+    return IsCorrect;
+}
+
+int main(int argc, char **argv)
+{
+    int NumTasks = 1 << 16;
+    if (argc == 2)
+    {
+        NumTasks = std::atoi(argv[1]);
+    }
+    if (NumTasks <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Number of Tasks]" << "\n";
+        return 1;
+    }
+
+    // Host producers and device consumers share the same cores
+    sycl::cpu_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    std::cout << "Producers,IntervalUs,NumTasks,NumWorkGroups,Tasks/s,MeanLatency(us),P50Latency(us),P99Latency(us)" << "\n";
+
+    // Consumers spin until the channel closes, leave cores for the producers and the collector
+    int ComputeUnits = Device.get_info<sycl::info::device::max_compute_units>();
+
+    bool AllCorrect = true;
+    for (int NumProducers : {1, 2, 4})
+    {
+        std::size_t NumWorkGroups = std::max(1, ComputeUnits - NumProducers - 1);
+        for (int IntervalUs : {0, 10, 100})
+        {
+            // paced runs are long, keep them to a fraction of the tasks
+            int Tasks = IntervalUs == 0 ? NumTasks : std::max(1, NumTasks / 16);
+            AllCorrect &= stream_run(Q, NumWorkGroups, Tasks, NumProducers, IntervalUs);
+        }
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Streamed tasks were lost or executed twice!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/ChaseLevDeque.hpp"
+#include "../tasking/Scheduler.hpp"
+#include "../tasking/TaskGraph.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Layered DAG: NumLevels levels of Width tasks, each task depends on
+    NumDeps tasks of the previous level
+    - Level by level: one kernel launch and host wait per level
+    - In-kernel: one persistent launch, dependencies resolved on the device
+*/
+constexpr int DequeCapacity = 1 << 14;
+constexpr std::size_t WorkGroupSize = 32;
+
+using DequeType = ChaseLevDeque<int, DequeCapacity>;
+
+struct WorkBody
+{
+    float *Out;
+    int *Stamp;
+    int *Clock;
+    int Iters;
+
+    void operator()(int TaskId) const
+    {
+        float Acc = TaskId;
+        for (int i = 0; i < Iters; i++)
+        {
+            Acc = Acc * 0.999f + 1.0f;
+        }
+        Out[TaskId] = Acc;
+        Stamp[TaskId] = sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(*Clock).fetch_add(1);
+    }
+};
+
+std::vector<std::vector<int>> layered_dag(int NumLevels, int Width, int NumDeps)
+{
+    std::vector<std::vector<int>> SuccessorLists(NumLevels * Width);
+    for (int Level = 1; Level < NumLevels; Level++)
+    {
+        for (int j = 0; j < Width; j++)
+        {
+            for (int k = 0; k < NumDeps; k++)
+            {
+                int Predecessor = (Level - 1) * Width + (j * 7 + k) % Width;
+                SuccessorLists[Predecessor].push_back(Level * Width + j);
+            }
+        }
+    }
+    return SuccessorLists;
+}
+
+/*
+    Every task ran exactly once and after all of its predecessors
+*/
+bool check_schedule(const std::vector<std::vector<int>> &SuccessorLists, const std::vector<int> &Stamp)
+{
+    std::vector<int> Seen(Stamp.size(), 0);
+    for (int s : Stamp)
+    {
+        if (s < 0 || s >= static_cast<int>(Stamp.size()) || Seen[s]++) return false;
+    }
+    for (std::size_t i = 0; i < SuccessorLists.size(); i++)
+    {
+        for (int Successor : SuccessorLists[i])
+        {
+            if (Stamp[i] >= Stamp[Successor]) return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int NumLevels = 64;
+    int Width = 256;
+    int NumDeps = 2;
+    int Iters = 256;
+    if (argc == 3)
+    {
+        NumLevels = std::atoi(argv[1]);
+        Width = std::atoi(argv[2]);
+    }
+    if (NumLevels <= 0 || Width <= 0 || Width > DequeCapacity)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Levels> <Width (<= " << DequeCapacity << ")>" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    const int NumTasks = NumLevels * Width;
+    auto SuccessorLists = layered_dag(NumLevels, Width, std::min(NumDeps, Width));
+    std::vector<int> HostRoots = graph_roots(SuccessorLists);
+    TaskGraph Graph = make_task_graph(Q, SuccessorLists);
+
+    float *Out = sycl::malloc_device<float>(NumTasks, Q);
+    int *Stamp = sycl::malloc_device<int>(NumTasks, Q);
+    int *Clock = sycl::malloc_device<int>(1, Q);
+    WorkBody Body{Out, Stamp, Clock, Iters};
+
+    std::vector<int> HostStamp(NumTasks);
+    bool AllCorrect = true;
+
+    std::cout << "Event,ExecTime(ms),NumTasks,NumLevels" << "\n";
+
+    // ------------------------
+    // LEVEL BY LEVEL
+    // ------------------------
+    Q.fill(Stamp, -1, NumTasks);
+    Q.fill(Clock, 0, 1);
+    Q.wait();
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+    for (int Level = 0; Level < NumLevels; Level++)
+    {
+        int FirstTask = Level * Width;
+        Q.parallel_for(Width, [=](sycl::id<1> idx)
+        {
+            Body(FirstTask + idx[0]);
+        });
+        Q.wait();
+    }
+    auto EndTimePoint = std::chrono::high_resolution_clock::now();
+    durationMiliSecs LevelTime = EndTimePoint - StartTimePoint;
+
+    Q.memcpy(HostStamp.data(), Stamp, NumTasks * sizeof(int));
+    Q.wait();
+    AllCorrect &= check_schedule(SuccessorLists, HostStamp);
+
+    std::cout << "Level By Level Exec Time" << "," << LevelTime.count() << "," << NumTasks << "," << NumLevels << "\n";
+
+    // ------------------------
+    // IN-KERNEL RESOLUTION
+    // ------------------------
+    std::size_t NumWorkGroups = Device.get_info<sycl::info::device::max_compute_units>();
+
+    auto Deques = sycl::malloc_device<DequeType>(NumWorkGroups, Q);
+    int *TasksLeft = sycl::malloc_device<int>(1, Q);
+    int *Roots = sycl::malloc_device<int>(HostRoots.size(), Q);
+
+    init_task_queues(Q, Deques, NumWorkGroups);
+    Q.memcpy(Roots, HostRoots.data(), HostRoots.size() * sizeof(int));
+    Q.fill(TasksLeft, NumTasks, 1);
+    Q.fill(Stamp, -1, NumTasks);
+    Q.fill(Clock, 0, 1);
+    reset_task_graph(Q, Graph);
+    Q.wait();
+
+    GraphTask<WorkBody> Task{Graph, Body};
+    StealingData<DequeType> Data{Deques, static_cast<int>(NumWorkGroups), static_cast<int>(HostRoots.size()), TasksLeft, true, Roots, Graph.Overflow};
+
+    StartTimePoint = std::chrono::high_resolution_clock::now();
+    sycl::event SchedulerEvent = stealing_execute<WorkGroupSize>(Q, Data, Task);
+    Q.wait();
+    EndTimePoint = std::chrono::high_resolution_clock::now();
+    durationMiliSecs GraphTime = EndTimePoint - StartTimePoint;
+
+    Q.memcpy(HostStamp.data(), Stamp, NumTasks * sizeof(int));
+    Q.wait();
+    AllCorrect &= check_schedule(SuccessorLists, HostStamp);
+    if (task_graph_overflowed(Q, Graph))
+    {
+        std::cerr << "A work-group deque overflowed, raise DequeCapacity" << "\n";
+        AllCorrect = false;
+    }
+
+    std::cout << "In-Kernel DAG Exec Time" << "," << GraphTime.count() << "," << NumTasks << "," << NumLevels << "\n";
+
+    sycl::free(Deques, Q);
+    sycl::free(TasksLeft, Q);
+    sycl::free(Roots, Q);
+    sycl::free(Out, Q);
+    sycl::free(Stamp, Q);
+    sycl::free(Clock, Q);
+    free_task_graph(Q, Graph);
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Dependency order violated!" << "\n";
+        return 1;
+    }
+    return 0;
+}
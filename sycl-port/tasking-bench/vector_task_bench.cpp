@@ -0,0 +1,164 @@
+#include <CL/sycl.hpp>
+#define VA_BENCH_DRIVER
+#include "../sycl_utils.hpp"
+#include "../device_verify.hpp"
+#include "../tasking/ArrayQueue.cpp"
+#include "../tasking/VectorTask.hpp"
+#include "../vector-add/basic-add-usm/vector_add_usm.cpp"
+
+/*
+    Vectorized range tasks against scalar range tasks and the plain
+    parallel_for of vector_add_usm.cpp
+    - Both task paths use the same grain, so the only difference is one
+      sycl::vec<int, Width> load/store per step instead of one int
+    - Bandwidth counts the two loads and one store per element
+    - The last size is odd so the scalar tail of the vectorized path is
+      measured and verified as well
+*/
+constexpr std::size_t WorkGroupSize = 32;
+
+using QueueType = SPMCArrayQueue<int, WorkGroupSize>;
+
+struct AddBody
+{
+    int *A;
+    int *B;
+    int *R;
+
+    void operator()(int Element) const
+    {
+        R[Element] = A[Element] + B[Element];
+    }
+
+    template<int N>
+    void lanes(int Begin) const
+    {
+        store_lanes<N>(load_lanes<N>(A, Begin) + load_lanes<N>(B, Begin), R, Begin);
+    }
+};
+
+double gb_per_sec(int VecSize, double TimeMs)
+{
+    return 3.0 * VecSize * sizeof(int) / (TimeMs * 1e-3) / 1e9;
+}
+
+/*
+    Width 0 runs the scalar RangeTask path
+*/
+double task_add(sycl::queue &Q, DeviceArena &Arena, QueueType *Queues, int NumQueues, const AddBody &Body, int VecSize, int Grain, int Width,
+    bool &IsCorrect)
+{
+    Q.fill(Body.R, 0, VecSize);
+    init_task_queues(Q, Queues, NumQueues);
+    Q.wait();
+
+    sycl::event SchedulerEvent = Width == 0 ? range_execute<WorkGroupSize>(Q, Queues, NumQueues, VecSize, Grain, Body)
+                                            : vector_range_execute<WorkGroupSize>(Q, Queues, NumQueues, VecSize, Grain, Width, Body);
+    Q.wait();
+
+    IsCorrect &= report_verification(Width == 0 ? "scalar tasks" : "vector tasks", VecSize,
+        verify_on_device(Q, Arena, Body.R, VecSize, ExpectedVectorAdd{}));
+    Arena.reset();
+
+    auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    return to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+}
+
+int main(int argc, char **argv)
+{
+    int MaxSize = 1 << 24;
+    int Reps = 5;
+    if (argc >= 2)
+    {
+        MaxSize = std::atoi(argv[1]);
+    }
+    if (argc == 3)
+    {
+        Reps = std::atoi(argv[2]);
+    }
+    if (MaxSize < 1024 || Reps <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [Max Vector Size >= 1024] [Repetitions]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    int Width = vector_width(Device);
+    std::cerr << "Vector width (int lanes): " << Width << "\n";
+
+    int NumQueues = Device.get_info<sycl::info::device::max_compute_units>();
+
+    auto Queues = sycl::malloc_device<QueueType>(NumQueues, Q);
+    AddBody Body;
+    Body.A = sycl::malloc_device<int>(MaxSize, Q);
+    Body.B = sycl::malloc_device<int>(MaxSize, Q);
+    Body.R = sycl::malloc_device<int>(MaxSize, Q);
+    Q.fill(Body.A, 1, MaxSize);
+    Q.fill(Body.B, 0, MaxSize);
+    Q.wait();
+
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(MaxSize) + verify_footprint());
+
+    std::vector<int> Sizes;
+    for (int VecSize = 1024; VecSize <= MaxSize; VecSize *= 2)
+    {
+        Sizes.push_back(VecSize);
+    }
+    Sizes.push_back(MaxSize - 1);
+
+    bool IsCorrect = true;
+
+    std::cout << "VectorSize,Width,Grain,Usm(GB/s),ScalarTasks(GB/s),VectorTasks(GB/s),VectorGain" << "\n";
+
+    try
+    {
+        for (int VecSize : Sizes)
+        {
+            // a few tasks per work-item to balance over, in whole vectors
+            int Grain = vector_grain(VecSize / (NumQueues * static_cast<int>(WorkGroupSize) * 4), Width);
+
+            std::vector<double> UsmTimes, ScalarTimes, VectorTimes;
+            for (int Rep = 0; Rep < Reps; Rep++)
+            {
+                std::vector<TimingEvent> Events;
+                IsCorrect &= basic_usm_add(Q, Arena, VecSize, Events);
+                for (const TimingEvent &Event : Events)
+                {
+                    if (Event.Name == "Kernel Exec Time") UsmTimes.push_back(Event.ExecTime);
+                }
+
+                ScalarTimes.push_back(task_add(Q, Arena, Queues, NumQueues, Body, VecSize, Grain, 0, IsCorrect));
+                VectorTimes.push_back(task_add(Q, Arena, Queues, NumQueues, Body, VecSize, Grain, Width, IsCorrect));
+            }
+
+            double ScalarTime = median(ScalarTimes);
+            double VectorTime = median(VectorTimes);
+            std::cout << VecSize << "," << Width << "," << Grain << "," << gb_per_sec(VecSize, median(UsmTimes)) << ","
+                      << gb_per_sec(VecSize, ScalarTime) << "," << gb_per_sec(VecSize, VectorTime) << "," << ScalarTime / VectorTime << "\n";
+        }
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    sycl::free(Queues, Q);
+    sycl::free(Body.A, Q);
+    sycl::free(Body.B, Q);
+    sycl::free(Body.R, Q);
+
+    if (!IsCorrect)
+    {
+        std::cerr << "Vectorized task vector add incorrect!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
+#include "../tasking/ChaseLevDeque.hpp"
+#include "../tasking/Scheduler.hpp"
+#include "../vector-add/va_profiler.cpp"
+
+/*
+    Skewed workload: every task initially owned by work-group 0 is
+    HeavyFactor times as expensive as the others, so with static
+    partitioning group 0 is a straggler while the rest sit idle
+*/
+constexpr int DequeCapacity = 1 << 14;
+constexpr std::size_t WorkGroupSize = 32;
+
+using DequeType = ChaseLevDeque<int, DequeCapacity>;
+
+struct SkewedTask : IndependentTask
+{
+    int *Executed;
+    float *Out;
+    int HeavyTasks;
+    int LightIters;
+    int HeavyIters;
+
+    void execute(int TaskId) const
+    {
+        int Iters = TaskId < HeavyTasks ? HeavyIters : LightIters;
+        float Acc = TaskId;
+        for (int i = 0; i < Iters; i++)
+        {
+            Acc = Acc * 0.999f + 1.0f;
+        }
+        Out[TaskId] = Acc;
+        sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+            sycl::access::address_space::global_space>(Executed[TaskId]).fetch_add(1);
+    }
+};
+
+bool skewed_run(sycl::queue &Q, const std::size_t NumWorkGroups, const int TasksPerGroup, const int HeavyFactor, bool EnableStealing)
+{
+    const int NumTasks = NumWorkGroups * TasksPerGroup;
+
+    auto Deques = sycl::malloc_device<DequeType>(NumWorkGroups, Q);
+    int *TasksLeft = sycl::malloc_device<int>(1, Q);
+    int *Executed = sycl::malloc_device<int>(NumTasks, Q);
+    float *Out = sycl::malloc_device<float>(NumTasks, Q);
+
+    init_task_queues(Q, Deques, NumWorkGroups);
+    Q.fill(TasksLeft, NumTasks, 1);
+    Q.fill(Executed, 0, NumTasks);
+    Q.wait();
+
+    SkewedTask Task;
+    Task.Executed = Executed;
+    Task.Out = Out;
+    Task.HeavyTasks = TasksPerGroup;
+    Task.LightIters = 64;
+    Task.HeavyIters = 64 * HeavyFactor;
+
+    StealingData<DequeType> Data{Deques, static_cast<int>(NumWorkGroups), NumTasks, TasksLeft, EnableStealing};
+    sycl::event SchedulerEvent = stealing_execute<WorkGroupSize>(Q, Data, Task);
+    Q.wait();
+
+    std::vector<int> HostExecuted(NumTasks);
+    Q.memcpy(HostExecuted.data(), Executed, NumTasks * sizeof(int));
+    Q.wait();
+
+    bool IsCorrect = true;
+    for (int i = 0; i < NumTasks; i++)
+    {
+        if (HostExecuted[i] != 1) IsCorrect = false;
+    }
+
+    auto StartKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = SchedulerEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    std::cout << (EnableStealing ? "Work Stealing" : "Static Partition") << ","
+              << KernelProfileTime << "," << NumTasks << "," << HeavyFactor << "," << NumWorkGroups << "\n";
+
+    sycl::free(Deques, Q);
+    sycl::free(TasksLeft, Q);
+    sycl::free(Executed, Q);
+    sycl::free(Out, Q);
+
+    return IsCorrect;
+}
+
+int main(int argc, char **argv)
+{
+    int TasksPerGroup = 1024;
+    if (argc == 2)
+    {
+        TasksPerGroup = std::atoi(argv[1]);
+    }
+    if (TasksPerGroup <= 0 || TasksPerGroup > DequeCapacity)
+    {
+        std::cerr << "Tasks per group must be in (0, " << DequeCapacity << "]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+    std::cerr << Device;
+
+    // Stealing groups spin until every task is done, so they must all be resident
+    std::size_t NumWorkGroups = Device.get_info<sycl::info::device::max_compute_units>();
+
+    std::cout << "Event,ExecTime(ms),NumTasks,HeavyFactor,NumWorkGroups" << "\n";
+
+    bool AllCorrect = true;
+    for (int HeavyFactor : {1, 4, 16, 64})
+    {
+        AllCorrect &= skewed_run(Q, NumWorkGroups, TasksPerGroup, HeavyFactor, false);
+        AllCorrect &= skewed_run(Q, NumWorkGroups, TasksPerGroup, HeavyFactor, true);
+    }
+
+    if (!AllCorrect)
+    {
+        std::cerr << "Some tasks were lost or executed twice!" << "\n";
+        return 1;
+    }
+    return 0;
+}
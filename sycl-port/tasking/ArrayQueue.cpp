@@ -1,3 +1,8 @@
+#ifndef __ARRAY_QUEUE_H__
+#define __ARRAY_QUEUE_H__
+
+#include <CL/sycl.hpp>
+
 /*
     - FIFO queue
     - Single producer multi consumer
@@ -44,11 +49,116 @@ class SPMCArrayQueue
             }
         }
 
+        /*
+            Bulk operations for a single caller
+            - push_n pushes as many of the n values as fit, returns how many
+            - pop_n copies up to n front elements out and pops them, returns how many
+        */
+        int push_n(const valueType *values, int n)
+        {
+            int count = n < maxSize - m_size ? n : maxSize - m_size;
+            for (int i = 0; i < count; i++)
+            {
+                m_elements[(m_nextElement + i) % maxSize] = values[i];
+            }
+            m_nextElement = (m_nextElement + count) % maxSize;
+            m_size += count;
+            return count;
+        }
+
+        int pop_n(valueType *values, int n)
+        {
+            int count = n < m_size ? n : m_size;
+            for (int i = 0; i < count; i++)
+            {
+                values[i] = front(i);
+            }
+            m_size -= count;
+            return count;
+        }
+
+        /*
+            Reserve n slots at the back in one step without writing them,
+            so many work-items can fill them in parallel through slot()
+            - The reserved elements are slot(size() - n) .. slot(size() - 1)
+            - Returns false (and reserves nothing) if they do not fit
+        */
+        bool reserve(int n)
+        {
+            if (m_size + n > maxSize)
+            {
+                return false;
+            }
+            m_nextElement = (m_nextElement + n) % maxSize;
+            m_size += n;
+            return true;
+        }
+
+        valueType &slot(int i)
+        {
+            int element = (maxSize + m_nextElement + i - m_size) % maxSize;
+            return m_elements[element];
+        }
+
+        /*
+            Group-cooperative operations, must be reached by the whole group
+            - group_push: work-items with local id < n each write their own
+              value, the leader updates the metadata once
+            - group_pop: the leader pops n elements on behalf of the group
+        */
+        template<typename Group>
+        bool group_push(Group g, const valueType &value, int n)
+        {
+            int localId = g.get_local_linear_id();
+            int nextElement = m_nextElement;
+            bool fits = m_size + n <= maxSize;
+
+            if (fits && localId < n)
+            {
+                m_elements[(nextElement + localId) % maxSize] = value;
+            }
+
+            sycl::group_barrier(g);
+
+            if (fits && g.leader())
+            {
+                m_nextElement = (nextElement + n) % maxSize;
+                m_size += n;
+            }
+
+            sycl::group_barrier(g);
+            return fits;
+        }
+
+        template<typename Group>
+        bool group_push(Group g, const valueType &value)
+        {
+            return group_push(g, value, g.get_local_linear_range());
+        }
+
+        template<typename Group>
+        void group_pop(Group g, int n)
+        {
+            sycl::group_barrier(g);
+
+            if (g.leader())
+            {
+                pop(n);
+            }
+
+            sycl::group_barrier(g);
+        }
+
         bool empty() const
         {
             return m_size == 0;
         }
 
+        bool full() const
+        {
+            return m_size == maxSize;
+        }
+
         int size() const
         {
             return m_size;
@@ -63,4 +173,5 @@ class SPMCArrayQueue
         int m_size; // current number of elements in the queue
         int m_nextElement; // index of the next available spot in the element array
         valueType m_elements[maxSize];
-};
\ No newline at end of file
+};
+#endif
@@ -0,0 +1,161 @@
+#ifndef __BUCKET_QUEUE_H__
+#define __BUCKET_QUEUE_H__
+
+#include <CL/sycl.hpp>
+
+/*
+    - Priority queue with numBuckets FIFO levels, a drop-in for
+      SPMCArrayQueue in persistent_execute
+    - Single producer multi consumer, no lock needed
+    - Values are task ids, their priority is looked up in a device table
+      (e.g. bottom levels from bottom_levels()); higher priority is served
+      first, FIFO within a bucket
+    - Bucket 0 holds only minPriority, the bulk of a typical DAG; anything
+      above it is spread over the other buckets on a log2 scale of
+      priority - minPriority, so a task just one level above the bulk is
+      already served before it and long chains keep some resolution
+    - front(i) reads a FIFO window of the windowSize most urgent elements.
+      Pushes only enter the window behind the elements already in it, so
+      the tasks workers read through front() stay in place until the
+      master pops them, as with the plain FIFO. windowSize must therefore
+      be at least the work-group size of the scheduler
+*/
+template<typename valueType, int maxSize, int windowSize, int numBuckets = 8>
+class SPMCBucketQueue
+{
+    static_assert(numBuckets >= 2, "SPMCBucketQueue needs a bucket for the minimum priority and one above it");
+
+    public:
+        SPMCBucketQueue() : SPMCBucketQueue(nullptr, 0, 0)
+        {
+        };
+        SPMCBucketQueue(const int *priority, int minPriority, int maxPriority)
+            : m_priority(priority), m_minPriority(minPriority), m_maxPriority(maxPriority), m_size(0), m_windowHead(0), m_windowSize(0)
+        {
+            for (int b = 0; b < numBuckets; b++)
+            {
+                m_bucketHead[b] = 0;
+                m_bucketSize[b] = 0;
+            }
+        };
+        ~SPMCBucketQueue()
+        {
+        };
+
+        const valueType &front(int i = 0)
+        {
+            return m_window[(m_windowHead + i) % windowSize];
+        }
+
+        void push(const valueType &value)
+        {
+            if (m_size < maxSize)
+            {
+                int b = bucket(value);
+                m_buckets[b][(m_bucketHead[b] + m_bucketSize[b]) % maxSize] = value;
+                m_bucketSize[b] += 1;
+                m_size += 1;
+                refill();
+            }
+        }
+
+        void pop(int n = 1)
+        {
+            if (m_windowSize >= n)
+            {
+                m_windowHead = (m_windowHead + n) % windowSize;
+                m_windowSize -= n;
+                m_size -= n;
+                refill();
+            }
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        bool full() const
+        {
+            return m_size == maxSize;
+        }
+
+        int size() const
+        {
+            return m_size;
+        }
+
+        int sizeMax() const
+        {
+            return maxSize;
+        }
+
+    private:
+        int bucket(const valueType &value) const
+        {
+            if (m_priority == nullptr || m_maxPriority <= m_minPriority)
+            {
+                return 0;
+            }
+            int p = m_priority[value];
+            if (p <= m_minPriority)
+            {
+                return 0;
+            }
+            p = p > m_maxPriority ? m_maxPriority : p;
+            int Range = log2_floor(m_maxPriority - m_minPriority);
+            return 1 + log2_floor(p - m_minPriority) * (numBuckets - 2) / (Range > 0 ? Range : 1);
+        }
+
+        static int log2_floor(int x)
+        {
+            int l = 0;
+            while (x > 1)
+            {
+                x >>= 1;
+                l += 1;
+            }
+            return l;
+        }
+
+        /*
+            Top the window up from the most urgent non-empty buckets
+        */
+        void refill()
+        {
+            for (int b = numBuckets - 1; b >= 0 && m_windowSize < windowSize; b--)
+            {
+                while (m_bucketSize[b] > 0 && m_windowSize < windowSize)
+                {
+                    m_window[(m_windowHead + m_windowSize) % windowSize] = m_buckets[b][m_bucketHead[b]];
+                    m_windowSize += 1;
+                    m_bucketHead[b] = (m_bucketHead[b] + 1) % maxSize;
+                    m_bucketSize[b] -= 1;
+                }
+            }
+        }
+
+        const int *m_priority; // device table indexed by value
+        int m_minPriority;
+        int m_maxPriority;
+        int m_size; // elements in the window and all buckets
+        int m_windowHead;
+        int m_windowSize;
+        valueType m_window[windowSize];
+        int m_bucketHead[numBuckets];
+        int m_bucketSize[numBuckets];
+        valueType m_buckets[numBuckets][maxSize];
+};
+
+/*
+    Build the per-group queues in parallel, all sharing one priority table
+*/
+template<typename QueueType>
+sycl::event init_priority_queues(sycl::queue &Q, QueueType *Queues, std::size_t NumQueues, const int *Priority, int MinPriority, int MaxPriority)
+{
+    return Q.parallel_for(NumQueues, [=](sycl::id<1> idx)
+    {
+        new (Queues + idx) QueueType(Priority, MinPriority, MaxPriority);
+    });
+}
+#endif
@@ -0,0 +1,120 @@
+#ifndef __CHASE_LEV_DEQUE_H__
+#define __CHASE_LEV_DEQUE_H__
+
+#include <CL/sycl.hpp>
+
+/*
+    - Bounded Chase-Lev work-stealing deque
+    - One owner pushes and pops at the bottom (LIFO)
+    - Any number of thieves steal from the top (FIFO) with a CAS on m_top
+    - Owner is expected to be a single work-item, e.g. a work-group master
+*/
+template<typename valueType, int maxSize>
+class ChaseLevDeque
+{
+    using atomicIndex = sycl::atomic_ref<
+            int,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>;
+
+    public:
+        ChaseLevDeque() : m_top(0), m_bottom(0)
+        {
+        };
+        ~ChaseLevDeque()
+        {
+        };
+
+        /*
+            Owner only, returns false if the deque is full
+        */
+        bool push(const valueType &value)
+        {
+            int b = atomicIndex(m_bottom).load();
+            int t = atomicIndex(m_top).load(sycl::memory_order::acquire);
+            if (b - t >= maxSize)
+            {
+                return false;
+            }
+
+            m_elements[b % maxSize] = value;
+            atomicIndex(m_bottom).store(b + 1, sycl::memory_order::release);
+            return true;
+        }
+
+        /*
+            Owner only, returns false if the deque is empty or the last
+            element was lost to a thief
+        */
+        bool pop(valueType &value)
+        {
+            atomicIndex bottom(m_bottom);
+            atomicIndex top(m_top);
+
+            int b = bottom.load() - 1;
+            bottom.store(b);
+            sycl::atomic_fence(sycl::memory_order::seq_cst, sycl::memory_scope::device);
+            int t = top.load();
+
+            if (t > b)
+            {
+                bottom.store(b + 1);
+                return false;
+            }
+
+            value = m_elements[b % maxSize];
+            if (t == b)
+            {
+                // Last element, race thieves for it
+                bool Won = top.compare_exchange_strong(t, t + 1, sycl::memory_order::seq_cst, sycl::memory_order::relaxed);
+                bottom.store(b + 1);
+                return Won;
+            }
+            return true;
+        }
+
+        /*
+            Any work-item, returns false if the deque is empty or another
+            thief won the race
+        */
+        bool steal(valueType &value)
+        {
+            atomicIndex top(m_top);
+
+            int t = top.load(sycl::memory_order::acquire);
+            sycl::atomic_fence(sycl::memory_order::seq_cst, sycl::memory_scope::device);
+            int b = atomicIndex(m_bottom).load(sycl::memory_order::acquire);
+
+            if (t >= b)
+            {
+                return false;
+            }
+
+            value = m_elements[t % maxSize];
+            return top.compare_exchange_strong(t, t + 1, sycl::memory_order::seq_cst, sycl::memory_order::relaxed);
+        }
+
+        int size() const
+        {
+            int b = atomicIndex(const_cast<int &>(m_bottom)).load();
+            int t = atomicIndex(const_cast<int &>(m_top)).load();
+            return b - t;
+        }
+
+        bool empty() const
+        {
+            return size() <= 0;
+        }
+
+        int sizeMax() const
+        {
+            return maxSize;
+        }
+
+    protected:
+        alignas(64) int m_top; // next element to steal
+        alignas(64) int m_bottom; // next free slot for the owner
+        valueType m_elements[maxSize];
+};
+#endif
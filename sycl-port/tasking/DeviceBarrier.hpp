@@ -0,0 +1,87 @@
+#ifndef __DEVICE_BARRIER_H__
+#define __DEVICE_BARRIER_H__
+
+#include <algorithm>
+#include <CL/sycl.hpp>
+
+/*
+    Device-wide sense-reversing barrier
+    - The leader of each work-group arrives on a shared counter, the last one
+      resets it and flips the global sense, the others spin until it flips
+    - Only safe if every participating work-group is resident at the same
+      time, launch with persistent_range() to stay within max_resident_groups()
+    - Lives in device memory, reach it through a pointer inside the kernel
+*/
+class DeviceBarrier
+{
+    using atomicInt = sycl::atomic_ref<
+            int,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>;
+
+public:
+    DeviceBarrier(int numGroups) : m_count(0), m_sense(0), m_numGroups(numGroups) {};
+    ~DeviceBarrier(){};
+
+    /*
+        Must be reached by every work-item of every participating group
+    */
+    template<typename Group>
+    void wait(Group g)
+    {
+        sycl::group_barrier(g);
+
+        if (g.leader())
+        {
+            atomicInt sense(m_sense);
+            // The sense cannot flip before this group arrives, so reading it first is safe
+            int localSense = sense.load(sycl::memory_order::acquire);
+
+            if (atomicInt(m_count).fetch_add(1, sycl::memory_order::acq_rel) == m_numGroups - 1)
+            {
+                atomicInt(m_count).store(0, sycl::memory_order::relaxed);
+                sense.store(1 - localSense, sycl::memory_order::release);
+            }
+            else
+            {
+                while (sense.load(sycl::memory_order::acquire) == localSense);
+            }
+        }
+
+        sycl::group_barrier(g);
+    }
+
+private:
+    int m_count; // groups arrived in the current phase
+    int m_sense; // flips every time the barrier opens
+    int m_numGroups;
+};
+
+/*
+    Work-groups assumed to be resident at once, GroupsPerUnit per compute unit
+    - Not an occupancy query: SYCL does not report how many groups of a kernel
+      fit a compute unit, that depends on its registers and local memory
+    - The default of one group per compute unit is the conservative choice
+      that holds for any kernel on the devices we run on; raise it only for
+      kernels whose occupancy is known
+*/
+std::size_t max_resident_groups(const sycl::device &Device, std::size_t WorkGroupSize, std::size_t GroupsPerUnit = 1)
+{
+    std::size_t ComputeUnits = Device.get_info<sycl::info::device::max_compute_units>();
+    std::size_t MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+    GroupsPerUnit = std::min(std::max<std::size_t>(GroupsPerUnit, 1), std::max<std::size_t>(1, MaxGroupSize / WorkGroupSize));
+    return ComputeUnits * GroupsPerUnit;
+}
+
+/*
+    nd_range for a persistent kernel: WantedGroups work-groups, clamped to
+    what can be co-resident so device-wide barriers make progress
+*/
+sycl::nd_range<1> persistent_range(const sycl::device &Device, std::size_t WorkGroupSize, std::size_t WantedGroups)
+{
+    std::size_t NumGroups = std::min(WantedGroups, max_resident_groups(Device, WorkGroupSize));
+    NumGroups = std::max<std::size_t>(NumGroups, 1);
+    return sycl::nd_range<1>{sycl::range<1>{NumGroups * WorkGroupSize}, sycl::range<1>{WorkGroupSize}};
+}
+#endif
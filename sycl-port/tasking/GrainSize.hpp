@@ -0,0 +1,134 @@
+#ifndef __GRAIN_SIZE_H__
+#define __GRAIN_SIZE_H__
+
+#include <algorithm>
+#include <cmath>
+#include <CL/sycl.hpp>
+#include "Scheduler.hpp"
+
+/*
+    Range tasks
+    - Task k covers the elements [k * Grain, min((k + 1) * Grain, NumElements))
+    - Queues keep holding plain int task ids, so every scheduler runs range tasks unchanged
+*/
+struct TaskRange
+{
+    int Begin;
+    int Length;
+};
+
+inline int num_range_tasks(int NumElements, int Grain)
+{
+    return (NumElements + Grain - 1) / Grain;
+}
+
+inline TaskRange task_range(int TaskId, int Grain, int NumElements)
+{
+    int Begin = TaskId * Grain;
+    return {Begin, std::min(Grain, NumElements - Begin)};
+}
+
+/*
+    BodyType must provide:
+        void operator()(int Element) const;
+*/
+template<typename BodyType>
+struct RangeTask : IndependentTask
+{
+    BodyType Body;
+    int NumElements;
+    int Grain;
+
+    void execute(int TaskId) const
+    {
+        TaskRange Range = task_range(TaskId, Grain, NumElements);
+        for (int i = Range.Begin; i < Range.Begin + Range.Length; i++)
+        {
+            Body(i);
+        }
+    }
+};
+
+/*
+    Persistent scheduler over NumElements elements in tasks of Grain elements each
+*/
+template<std::size_t WorkGroupSize, typename QueueType, typename BodyType>
+sycl::event range_execute(sycl::queue &Q, QueueType *Queues, int NumQueues, int NumElements, int Grain, BodyType Body)
+{
+    InitData<QueueType> Data{Queues, NumQueues, num_range_tasks(NumElements, Grain)};
+    return persistent_execute<WorkGroupSize>(Q, Data, RangeTask<BodyType>{{}, Body, NumElements, Grain});
+}
+
+/*
+    Host-side grain-size controller
+    - Models a measured run as Time = Tasks * TaskOverhead + Elements * ElementCost
+    - Both terms are fitted by least squares over every recorded run, older runs
+      fade out with Decay so the estimate follows the device at runtime
+    - grain() picks the smallest grain whose per-task overhead stays below
+      OverheadShare of the task's work, capped so every worker still gets
+      TasksPerWorker tasks to balance over
+    - Until two runs with different task counts are recorded the model is
+      unknown and grain() falls back to the load-balancing cap
+*/
+class GrainController
+{
+public:
+    GrainController(int Workers, double OverheadShare = 0.1, int TasksPerWorker = 4, double Decay = 0.8)
+        : m_workers(std::max(Workers, 1)), m_overheadShare(OverheadShare), m_tasksPerWorker(std::max(TasksPerWorker, 1)), m_decay(Decay)
+    {
+    }
+
+    void record(int NumElements, int Grain, double Time)
+    {
+        double Tasks = num_range_tasks(NumElements, Grain);
+        double Elements = NumElements;
+
+        m_tt = m_decay * m_tt + Tasks * Tasks;
+        m_te = m_decay * m_te + Tasks * Elements;
+        m_ee = m_decay * m_ee + Elements * Elements;
+        m_ty = m_decay * m_ty + Tasks * Time;
+        m_ey = m_decay * m_ey + Elements * Time;
+
+        double Det = m_tt * m_ee - m_te * m_te;
+        if (Det <= 1e-9 * m_tt * m_ee)
+        {
+            return;
+        }
+
+        // a negative fit means the term is lost in noise, keep it tiny but positive
+        m_taskOverhead = std::max((m_ee * m_ty - m_te * m_ey) / Det, 1e-12);
+        m_elementCost = std::max((m_tt * m_ey - m_te * m_ty) / Det, 1e-12);
+        m_calibrated = true;
+    }
+
+    int grain(int NumElements) const
+    {
+        int MaxGrain = std::max(1, NumElements / (m_workers * m_tasksPerWorker));
+        if (!m_calibrated)
+        {
+            return MaxGrain;
+        }
+
+        double Wanted = std::ceil(m_taskOverhead / (m_overheadShare * m_elementCost));
+        return static_cast<int>(std::min<double>(std::max(Wanted, 1.0), MaxGrain));
+    }
+
+    bool calibrated() const { return m_calibrated; }
+    double task_overhead() const { return m_taskOverhead; }
+    double element_cost() const { return m_elementCost; }
+
+private:
+    int m_workers;
+    double m_overheadShare;
+    int m_tasksPerWorker;
+    double m_decay;
+
+    // decayed normal-equation sums of the (Tasks, Elements) -> Time fit
+    double m_tt = 0, m_te = 0, m_ee = 0, m_ty = 0, m_ey = 0;
+
+    bool m_calibrated = false;
+    double m_taskOverhead = 0;
+    double m_elementCost = 0;
+};
+
+#endif
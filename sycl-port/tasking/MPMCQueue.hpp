@@ -0,0 +1,136 @@
+#ifndef __MPMC_QUEUE_H__
+#define __MPMC_QUEUE_H__
+
+#include <CL/sycl.hpp>
+
+/*
+    - FIFO queue
+    - Multi producer multi consumer
+    - Lock free: head/tail are claimed with atomic_ref, each slot carries a
+      sequence number telling whether it is free to write or ready to read
+    - No group barrier or Mutex needed, any work-item in any group may call it
+*/
+template<typename valueType, unsigned int maxSize>
+class MPMCArrayQueue
+{
+    static_assert(maxSize > 0 && (maxSize & (maxSize - 1)) == 0, "MPMCArrayQueue size must be a power of two");
+
+    using atomicIndex = sycl::atomic_ref<
+            unsigned int,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::device,
+            sycl::access::address_space::global_space>;
+
+    public:
+        MPMCArrayQueue() : m_head(0), m_tail(0)
+        {
+            for (unsigned int i = 0; i < maxSize; i++)
+            {
+                m_sequence[i] = i;
+            }
+        };
+        ~MPMCArrayQueue()
+        {
+        };
+
+        /*
+            Returns false if the queue is full
+        */
+        bool try_push(const valueType &value)
+        {
+            atomicIndex tail(m_tail);
+            unsigned int pos = tail.load();
+
+            while (true)
+            {
+                atomicIndex sequence(m_sequence[pos & (maxSize - 1)]);
+                unsigned int seq = sequence.load(sycl::memory_order::acquire);
+                int dif = static_cast<int>(seq - pos);
+
+                if (dif == 0)
+                {
+                    if (tail.compare_exchange_weak(pos, pos + 1))
+                    {
+                        break;
+                    }
+                }
+                else if (dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = tail.load();
+                }
+            }
+
+            m_elements[pos & (maxSize - 1)] = value;
+            atomicIndex(m_sequence[pos & (maxSize - 1)]).store(pos + 1, sycl::memory_order::release);
+            return true;
+        }
+
+        /*
+            Returns false if the queue is empty, or the next element is
+            claimed but not yet published by its producer
+        */
+        bool try_pop(valueType &value)
+        {
+            atomicIndex head(m_head);
+            unsigned int pos = head.load();
+
+            while (true)
+            {
+                atomicIndex sequence(m_sequence[pos & (maxSize - 1)]);
+                unsigned int seq = sequence.load(sycl::memory_order::acquire);
+                int dif = static_cast<int>(seq - (pos + 1));
+
+                if (dif == 0)
+                {
+                    if (head.compare_exchange_weak(pos, pos + 1))
+                    {
+                        break;
+                    }
+                }
+                else if (dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = head.load();
+                }
+            }
+
+            value = m_elements[pos & (maxSize - 1)];
+            atomicIndex(m_sequence[pos & (maxSize - 1)]).store(pos + maxSize, sycl::memory_order::release);
+            return true;
+        }
+
+        /*
+            Approximate under contention
+        */
+        int size() const
+        {
+            unsigned int head = atomicIndex(const_cast<unsigned int &>(m_head)).load();
+            unsigned int tail = atomicIndex(const_cast<unsigned int &>(m_tail)).load();
+            return static_cast<int>(tail - head);
+        }
+
+        bool empty() const
+        {
+            return size() <= 0;
+        }
+
+        int sizeMax() const
+        {
+            return maxSize;
+        }
+
+    protected:
+        // head and tail on separate cache lines so producers and consumers don't false share
+        alignas(64) unsigned int m_head; // next position to pop
+        alignas(64) unsigned int m_tail; // next position to push
+        unsigned int m_sequence[maxSize]; // per-slot sequence number
+        valueType m_elements[maxSize];
+};
+#endif
@@ -0,0 +1,208 @@
+#ifndef __MULTI_DEVICE_H__
+#define __MULTI_DEVICE_H__
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <CL/sycl.hpp>
+#include "Scheduler.hpp"
+
+/*
+    Split Root into the devices that get their own queues
+    - "numa": one sub-device per NUMA node (affinity domain partition)
+    - "equal:N": sub-devices of N compute units each
+    - "all": every device of Root's platform with Root's type, e.g. several GPUs
+    - anything else, or a partition the device does not support, gives {Root}
+*/
+std::vector<sycl::device> partition_device(const sycl::device &Root, const std::string &Mode)
+{
+    std::vector<sycl::device> Devices;
+    try
+    {
+        if (Mode == "numa")
+        {
+            Devices = Root.create_sub_devices<sycl::info::partition_property::partition_by_affinity_domain>(
+                sycl::info::partition_affinity_domain::numa);
+        }
+        else if (Mode.rfind("equal:", 0) == 0)
+        {
+            std::size_t ComputeUnits = std::stoul(Mode.substr(6));
+            Devices = Root.create_sub_devices<sycl::info::partition_property::partition_equally>(ComputeUnits);
+        }
+        else if (Mode == "all")
+        {
+            Devices = Root.get_platform().get_devices(Root.get_info<sycl::info::device::device_type>());
+        }
+    }
+    catch (const sycl::exception &e)
+    {
+        std::cerr << "Cannot partition device (" << Mode << "): " << e.what() << "\n";
+        Devices.clear();
+    }
+
+    if (Devices.empty())
+    {
+        Devices.push_back(Root);
+    }
+    return Devices;
+}
+
+/*
+    USM that every device in Devices can access
+    - A shared allocation is only guaranteed to be accessible from the device
+      it was made for, so it is used for a single device only
+    - Several devices get a host allocation, visible to every device of the
+      context that reports aspect::usm_host_allocations
+    - nullptr when a device supports neither
+*/
+template<typename T>
+T *malloc_all_devices(std::size_t Count, const sycl::context &Context, const std::vector<sycl::device> &Devices)
+{
+    if (Devices.size() == 1 && Devices[0].has(sycl::aspect::usm_shared_allocations))
+    {
+        return sycl::malloc_shared<T>(Count, Devices[0], Context);
+    }
+    for (const sycl::device &Device : Devices)
+    {
+        if (!Device.has(sycl::aspect::usm_host_allocations))
+        {
+            return nullptr;
+        }
+    }
+    return sycl::malloc_host<T>(Count, Context);
+}
+
+/*
+    Host-side coordinator handing out task chunks to devices
+    - Tasks start in one contiguous block per device, so each device mostly
+      touches the data its own first-touch initialisation placed near it
+    - A device takes chunks from the front of its own block; once that is
+      empty it takes half of the largest remaining block from the back
+    - All decisions happen under one host mutex, devices only ask between kernels
+*/
+class DeviceCoordinator
+{
+    public:
+        DeviceCoordinator(int NumTasks, int NumDevices, int ChunkSize)
+            : m_chunkSize(std::max(ChunkSize, 1)), m_begin(NumDevices), m_end(NumDevices), m_stolen(NumDevices, 0)
+        {
+            for (int d = 0; d < NumDevices; d++)
+            {
+                m_begin[d] = static_cast<long long>(NumTasks) * d / NumDevices;
+                m_end[d] = static_cast<long long>(NumTasks) * (d + 1) / NumDevices;
+            }
+        };
+
+        /*
+            First task of Device's initial block
+        */
+        int block_begin(int Device) const
+        {
+            return m_begin[Device];
+        }
+
+        /*
+            Returns false once no device has tasks left
+        */
+        bool next_chunk(int Device, int &Begin, int &Length)
+        {
+            std::lock_guard<std::mutex> Lock(m_mutex);
+
+            if (m_begin[Device] < m_end[Device])
+            {
+                Begin = m_begin[Device];
+                Length = std::min(m_chunkSize, m_end[Device] - m_begin[Device]);
+                m_begin[Device] += Length;
+                return true;
+            }
+
+            int Victim = -1;
+            int Largest = 0;
+            for (int d = 0; d < static_cast<int>(m_begin.size()); d++)
+            {
+                if (m_end[d] - m_begin[d] > Largest)
+                {
+                    Largest = m_end[d] - m_begin[d];
+                    Victim = d;
+                }
+            }
+            if (Victim < 0)
+            {
+                return false;
+            }
+
+            Length = std::min(m_chunkSize, (Largest + 1) / 2);
+            Begin = m_end[Victim] - Length;
+            m_end[Victim] = Begin;
+            m_stolen[Device] += Length;
+            return true;
+        }
+
+        /*
+            Tasks Device took from other devices' blocks
+        */
+        int stolen(int Device) const
+        {
+            return m_stolen[Device];
+        }
+
+    private:
+        std::mutex m_mutex;
+        int m_chunkSize;
+        std::vector<int> m_begin;
+        std::vector<int> m_end;
+        std::vector<int> m_stolen;
+};
+
+/*
+    Shifts the ids of a chunk back to global task ids
+*/
+template<typename TaskType>
+struct OffsetTask : IndependentTask
+{
+    TaskType Task;
+    int Offset;
+
+    void execute(int TaskId) const
+    {
+        Task.execute(Offset + TaskId);
+    }
+};
+
+/*
+    One host thread per device runs persistent_execute on the chunks the
+    coordinator hands it, with that device's own queue and task queues
+    - Every chunk is one persistent_execute launch plus a wait on that
+      device's queue, so rebalancing is paid in kernel launches: a chunk
+      must be long enough to hide a launch round trip
+    - TaskQueues[d] must hold NumWorkGroups[d] constructed queues on Queues[d]
+*/
+template<std::size_t WorkGroupSize, typename QueueType, typename TaskType>
+void multi_device_execute(std::vector<sycl::queue> &Queues, const std::vector<QueueType *> &TaskQueues,
+    const std::vector<std::size_t> &NumWorkGroups, DeviceCoordinator &Coordinator, TaskType Task)
+{
+    std::vector<std::thread> Workers;
+    for (std::size_t d = 0; d < Queues.size(); d++)
+    {
+        Workers.emplace_back([&, d]()
+        {
+            int Begin;
+            int Length;
+            while (Coordinator.next_chunk(d, Begin, Length))
+            {
+                InitData<QueueType> Data{TaskQueues[d], static_cast<int>(NumWorkGroups[d]), Length};
+                persistent_execute<WorkGroupSize>(Queues[d], Data, OffsetTask<TaskType>{{}, Task, Begin});
+                Queues[d].wait();
+            }
+        });
+    }
+
+    for (std::thread &Worker : Workers)
+    {
+        Worker.join();
+    }
+}
+
+#endif
@@ -2,33 +2,149 @@
 #define __MUTEX_H__
 
 #include <CL/sycl.hpp>
-#include <atomic>
-#include <thread>
+
+/*
+    Device lock family
+    - Every lock keeps its state in plain ints and builds the atomic_ref when
+      used, so the lock object must live in device memory (e.g. USM) and be
+      reached through a pointer or reference inside the kernel, never copied
+    - Work-item level locks spin, so avoid having several work-items of one
+      group contend at once: lanes running in lockstep can wait on a lane that
+      never gets to release. Use GroupLock to acquire on behalf of a group
+*/
+using lockAtomic = sycl::atomic_ref<
+        int,
+        sycl::memory_order::relaxed,
+        sycl::memory_scope::device,
+        sycl::access::address_space::global_space>;
+
+/*
+    Test-and-set spin lock
+*/
 class Mutex
 {
 public:
-    Mutex() : atomic_mutex(mutex) {};
+    Mutex() : mutex(0) {};
     ~Mutex(){};
     void lock()
     {
+        lockAtomic atomic_mutex(mutex);
         int expected = 0;
         int desired = 1;
-        while (atomic_mutex.compare_exchange_weak(expected, desired, sycl::memory_order_acq_rel, sycl::memory_order_acquire) != true);
- 
-        sycl::atomic_fence(sycl::memory_order::acq_rel, sycl::memory_scope::device);
+        // A failed CAS writes the current value into expected, reset it every try
+        while (atomic_mutex.compare_exchange_weak(expected, desired, sycl::memory_order::acquire, sycl::memory_order::relaxed) != true)
+        {
+            expected = 0;
+        }
+    };
+    void unlock()
+    {
+        lockAtomic(mutex).store(0, sycl::memory_order::release);
+    };
+
+private:
+    int mutex;
+};
+
+/*
+    FIFO-fair ticket lock: take a ticket, wait until it is served
+*/
+class TicketLock
+{
+public:
+    TicketLock() : m_nextTicket(0), m_nowServing(0) {};
+    ~TicketLock(){};
+    void lock()
+    {
+        int ticket = lockAtomic(m_nextTicket).fetch_add(1);
+        lockAtomic nowServing(m_nowServing);
+        while (nowServing.load(sycl::memory_order::acquire) != ticket);
+    };
+    void unlock()
+    {
+        // Only the holder writes m_nowServing
+        lockAtomic nowServing(m_nowServing);
+        nowServing.store(nowServing.load() + 1, sycl::memory_order::release);
+    };
+
+private:
+    int m_nextTicket;
+    int m_nowServing;
+};
+
+/*
+    Test-and-test-and-set lock with exponential backoff
+    - Spins on a plain load so waiters don't hammer the line with CASes
+    - After a lost race waits Delay polls, doubling up to maxDelay
+*/
+template<int minDelay = 4, int maxDelay = 1024>
+class BackoffLock
+{
+public:
+    BackoffLock() : m_state(0) {};
+    ~BackoffLock(){};
+    void lock()
+    {
+        lockAtomic state(m_state);
+        int delay = minDelay;
+        while (true)
+        {
+            while (state.load(sycl::memory_order::relaxed) != 0);
+
+            if (state.exchange(1, sycl::memory_order::acquire) == 0)
+            {
+                return;
+            }
+
+            for (int i = 0; i < delay; i++)
+            {
+                state.load(sycl::memory_order::relaxed);
+            }
+            delay = delay * 2 < maxDelay ? delay * 2 : maxDelay;
+        }
     };
     void unlock()
     {
-        sycl::atomic_fence(sycl::memory_order::acq_rel, sycl::memory_scope::device);
-        atomic_mutex.exchange(0);
+        lockAtomic(m_state).store(0, sycl::memory_order::release);
+    };
+
+private:
+    int m_state;
+};
+
+/*
+    Work-group aggregated lock: the group leader acquires the inner lock on
+    behalf of the whole group, so only one contender per group hits memory.
+    lock/unlock must be reached by every work-item of the group
+*/
+template<typename LockType>
+class GroupLock
+{
+public:
+    GroupLock() {};
+    ~GroupLock(){};
+
+    template<typename Group>
+    void lock(Group g)
+    {
+        if (g.leader())
+        {
+            m_lock.lock();
+        }
+        sycl::group_barrier(g);
+    };
+
+    template<typename Group>
+    void unlock(Group g)
+    {
+        sycl::group_barrier(g);
+        if (g.leader())
+        {
+            m_lock.unlock();
+        }
     };
 
 private:
-    int mutex = 0;
-    sycl::atomic_ref<
-            int,
-            sycl::memory_order::acq_rel,
-            sycl::memory_scope::device,
-            sycl::access::address_space::global_space> atomic_mutex;
+    LockType m_lock;
 };
 #endif
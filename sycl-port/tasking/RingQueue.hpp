@@ -0,0 +1,314 @@
+#ifndef __RING_QUEUE_H__
+#define __RING_QUEUE_H__
+
+#include <CL/sycl.hpp>
+#include "../device_arena.hpp"
+
+/*
+    - FIFO queue, same interface as SPMCArrayQueue
+    - Single producer multi consumer
+    - Capacity picked at runtime and rounded up to a power of two, so
+      indexing is a mask instead of a modulo
+    - Slots live in separately allocated device memory, see make_ring_queues
+*/
+template<typename valueType>
+class SPMCRingQueue
+{
+    public:
+        SPMCRingQueue(valueType *elements, int capacity) :
+            m_size(0), m_nextElement(0), m_mask(capacity - 1), m_elements(elements)
+        {
+        };
+        ~SPMCRingQueue()
+        {
+        };
+
+        const valueType &front(int i = 0)
+        {
+            return m_elements[(m_nextElement + i - m_size) & m_mask];
+        }
+
+        const valueType &back()
+        {
+            return m_elements[(m_nextElement - 1) & m_mask];
+        }
+
+        void push(const valueType &value)
+        {
+            if (m_size <= m_mask)
+            {
+                m_elements[m_nextElement] = value;
+                m_nextElement = (m_nextElement + 1) & m_mask;
+                m_size += 1;
+            }
+        }
+
+        void pop(int n = 1)
+        {
+            if (m_size >= n)
+            {
+                m_size -= n;
+            }
+        }
+
+        /*
+            Bulk operations, see SPMCArrayQueue
+        */
+        int push_n(const valueType *values, int n)
+        {
+            int count = n < sizeMax() - m_size ? n : sizeMax() - m_size;
+            for (int i = 0; i < count; i++)
+            {
+                m_elements[(m_nextElement + i) & m_mask] = values[i];
+            }
+            m_nextElement = (m_nextElement + count) & m_mask;
+            m_size += count;
+            return count;
+        }
+
+        int pop_n(valueType *values, int n)
+        {
+            int count = n < m_size ? n : m_size;
+            for (int i = 0; i < count; i++)
+            {
+                values[i] = front(i);
+            }
+            m_size -= count;
+            return count;
+        }
+
+        bool reserve(int n)
+        {
+            if (m_size + n > sizeMax())
+            {
+                return false;
+            }
+            m_nextElement = (m_nextElement + n) & m_mask;
+            m_size += n;
+            return true;
+        }
+
+        valueType &slot(int i)
+        {
+            return m_elements[(m_nextElement + i - m_size) & m_mask];
+        }
+
+        template<typename Group>
+        bool group_push(Group g, const valueType &value, int n)
+        {
+            int localId = g.get_local_linear_id();
+            int nextElement = m_nextElement;
+            bool fits = m_size + n <= sizeMax();
+
+            if (fits && localId < n)
+            {
+                m_elements[(nextElement + localId) & m_mask] = value;
+            }
+
+            sycl::group_barrier(g);
+
+            if (fits && g.leader())
+            {
+                m_nextElement = (nextElement + n) & m_mask;
+                m_size += n;
+            }
+
+            sycl::group_barrier(g);
+            return fits;
+        }
+
+        template<typename Group>
+        bool group_push(Group g, const valueType &value)
+        {
+            return group_push(g, value, g.get_local_linear_range());
+        }
+
+        template<typename Group>
+        void group_pop(Group g, int n)
+        {
+            sycl::group_barrier(g);
+
+            if (g.leader())
+            {
+                pop(n);
+            }
+
+            sycl::group_barrier(g);
+        }
+
+        /*
+            Local-memory staging of the queue head, group-cooperative
+            - Meta is local memory for 3 ints: staged count, head slot and
+              completed count
+            - group_stage: the leader reads m_size/m_nextElement once per round
+              and clears the completed count, the group then copies up to n
+              front elements into the local Slots; workers dispatch from
+              Slots[i] instead of front(i)
+            - complete: marks one staged task done with a local atomic
+            - group_retire: the leader pops the completed count in one update
+        */
+        template<typename Group, typename LocalSlots, typename LocalMeta>
+        int group_stage(Group g, LocalSlots Slots, LocalMeta Meta, int n)
+        {
+            if (g.leader())
+            {
+                Meta[0] = m_size < n ? m_size : n;
+                Meta[1] = (m_nextElement - m_size) & m_mask;
+                Meta[2] = 0;
+            }
+
+            sycl::group_barrier(g);
+
+            int count = Meta[0];
+            int head = Meta[1];
+            for (int i = g.get_local_linear_id(); i < count; i += g.get_local_linear_range())
+            {
+                Slots[i] = m_elements[(head + i) & m_mask];
+            }
+
+            sycl::group_barrier(g);
+            return count;
+        }
+
+        template<typename LocalMeta>
+        static void complete(LocalMeta Meta)
+        {
+            sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::work_group,
+                sycl::access::address_space::local_space>(Meta[2]).fetch_add(1);
+        }
+
+        template<typename Group, typename LocalMeta>
+        void group_retire(Group g, LocalMeta Meta)
+        {
+            sycl::group_barrier(g);
+
+            if (g.leader())
+            {
+                pop(Meta[2]);
+            }
+
+            sycl::group_barrier(g);
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        bool full() const
+        {
+            return m_size == sizeMax();
+        }
+
+        int size() const
+        {
+            return m_size;
+        }
+
+        int sizeMax() const
+        {
+            return m_mask + 1;
+        }
+
+    protected:
+        int m_size; // current number of elements in the queue
+        int m_nextElement; // index of the next available spot in the element array
+        int m_mask; // capacity - 1
+        valueType *m_elements; // external slot storage
+};
+
+/*
+    Smallest power of two >= n
+*/
+std::size_t round_up_pow2(std::size_t n)
+{
+    std::size_t pow2 = 1;
+    while (pow2 < n)
+    {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+/*
+    NumQueues ring queues sharing one slot allocation
+*/
+template<typename valueType>
+struct RingQueueSet
+{
+    SPMCRingQueue<valueType> *Queues;
+    valueType *Storage;
+    std::size_t NumQueues;
+    std::size_t Capacity; // per queue, a power of two
+    sycl::event InitEvent; // construction kernel, complete once make_ring_queues returns
+};
+
+/*
+    Construct every queue of the set with a parallel kernel (one work-item per queue)
+*/
+template<typename valueType>
+sycl::event init_ring_queues(sycl::queue &Q, const RingQueueSet<valueType> &Set)
+{
+    auto Queues = Set.Queues;
+    auto Storage = Set.Storage;
+    int Capacity = Set.Capacity;
+    return Q.parallel_for(Set.NumQueues, [=](sycl::id<1> idx)
+    {
+        new (Queues + idx) SPMCRingQueue<valueType>(Storage + idx[0] * Capacity, Capacity);
+    });
+}
+
+/*
+    Allocate the queues and their slots with sycl::malloc_device,
+    release them with free_ring_queues
+*/
+template<typename valueType>
+RingQueueSet<valueType> make_ring_queues(sycl::queue &Q, std::size_t NumQueues, std::size_t MinCapacity)
+{
+    RingQueueSet<valueType> Set;
+    Set.NumQueues = NumQueues;
+    Set.Capacity = round_up_pow2(MinCapacity);
+    Set.Queues = sycl::malloc_device<SPMCRingQueue<valueType>>(NumQueues, Q);
+    Set.Storage = sycl::malloc_device<valueType>(NumQueues * Set.Capacity, Q);
+
+    Set.InitEvent = init_ring_queues(Q, Set);
+    Q.wait();
+
+    return Set;
+}
+
+/*
+    Same, but carved out of an arena, released by resetting the arena
+*/
+template<typename valueType>
+RingQueueSet<valueType> make_ring_queues(sycl::queue &Q, DeviceArena &Arena, std::size_t NumQueues, std::size_t MinCapacity)
+{
+    RingQueueSet<valueType> Set;
+    Set.NumQueues = NumQueues;
+    Set.Capacity = round_up_pow2(MinCapacity);
+    Set.Queues = Arena.allocate<SPMCRingQueue<valueType>>(NumQueues);
+    Set.Storage = Arena.allocate<valueType>(NumQueues * Set.Capacity);
+
+    Set.InitEvent = init_ring_queues(Q, Set);
+    Q.wait();
+
+    return Set;
+}
+
+/*
+    Arena bytes needed by make_ring_queues
+*/
+template<typename valueType>
+std::size_t ring_queues_footprint(std::size_t NumQueues, std::size_t MinCapacity)
+{
+    return DeviceArena::footprint<SPMCRingQueue<valueType>>(NumQueues)
+         + DeviceArena::footprint<valueType>(NumQueues * round_up_pow2(MinCapacity));
+}
+
+template<typename valueType>
+void free_ring_queues(sycl::queue &Q, RingQueueSet<valueType> &Set)
+{
+    sycl::free(Set.Queues, Q);
+    sycl::free(Set.Storage, Q);
+}
+#endif
@@ -0,0 +1,301 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <algorithm>
+#include <CL/sycl.hpp>
+#include "ArrayQueue.cpp"
+#include "ChaseLevDeque.hpp"
+
+/*
+    Persistent GPU-Eventify work loop
+    - Launched once as an nd_range kernel, one task queue per work-group
+    - Master work-item (local id 0) fills the queue and resolves dependencies
+    - Workers execute queue->front(ID) until the queue drains and no work is left
+    - Launch rule: one work-group per compute unit (max_compute_units), never
+      more than there is work for; the groups loop instead of being relaunched
+
+    TaskType must provide:
+        void execute(int TaskId) const;
+        template<typename Queue> void solve_dependencies(int TaskId, Queue &TaskQueue) const;
+    solve_dependencies runs on the master only and may push newly ready tasks,
+    as long as the queue is not full().
+*/
+template<typename QueueType>
+struct InitData
+{
+    QueueType *Queues; // one queue per work-group
+    int NumQueues;
+    int NumTasks; // initial tasks 0..NumTasks-1, split evenly over the queues
+};
+
+/*
+    Task type for work without dependencies
+*/
+struct IndependentTask
+{
+    template<typename Queue>
+    void solve_dependencies(int, Queue &) const
+    {
+    }
+};
+
+/*
+    Build the per-group queues in parallel, one work-item per queue
+*/
+template<typename QueueType>
+sycl::event init_task_queues(sycl::queue &Q, QueueType *Queues, std::size_t NumQueues)
+{
+    return Q.parallel_for(NumQueues, [=](sycl::id<1> idx)
+    {
+        new (Queues + idx) QueueType();
+    });
+}
+
+template<std::size_t WorkGroupSize, typename QueueType, typename TaskType>
+sycl::event persistent_execute(sycl::queue &Q, InitData<QueueType> Data, TaskType Task)
+{
+    const std::size_t GlobalSize = Data.NumQueues * WorkGroupSize;
+    const int TasksPerQueue = (Data.NumTasks + Data.NumQueues - 1) / Data.NumQueues;
+
+    return Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{GlobalSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            int ID = Item.get_local_id(0);
+            int QueueIdx = Item.get_group_linear_id();
+            auto &TargetQueue = Data.Queues[QueueIdx];
+
+            // Only the master tracks the initial tasks still waiting for a free slot
+            int NextTask = QueueIdx * TasksPerQueue;
+            int LastTask = std::min(NextTask + TasksPerQueue, Data.NumTasks);
+
+            while (true)
+            {
+                if (ID == 0)
+                {
+                    while (NextTask < LastTask && !TargetQueue.full())
+                    {
+                        TargetQueue.push(NextTask++);
+                    }
+                }
+
+                sycl::group_barrier(Group);
+
+                int QueueSize = TargetQueue.size();
+                if (QueueSize == 0)
+                {
+                    break;
+                }
+
+                int TasksDone = std::min(QueueSize, static_cast<int>(WorkGroupSize));
+                if (ID < TasksDone)
+                {
+                    Task.execute(TargetQueue.front(ID));
+                }
+
+                sycl::group_barrier(Group);
+
+                // master handles dependency resolution
+                if (ID == 0)
+                {
+                    for (int i = 0; i < TasksDone; i++)
+                    {
+                        Task.solve_dependencies(TargetQueue.front(i), TargetQueue);
+                    }
+                    TargetQueue.pop(TasksDone);
+                }
+            }
+        });
+    });
+}
+
+/*
+    Persistent work loop with work-stealing
+    - Each work-group owns a ChaseLevDeque, the master pops a batch from the bottom
+    - When its own deque is empty the master steals from the top of random victims
+    - Groups leave the loop once the device-wide TasksLeft counter reaches zero,
+      so launch no more groups than can be resident at once, one per compute
+      unit as for persistent_execute
+    - Initial tasks that do not fit the deque stay with the master and are
+      pushed as it drains, as in persistent_execute
+    - Tasks made ready by solve_dependencies go to the master's own deque;
+      a task type whose push fails must set *Overflow, every group then
+      stops instead of waiting for a task that was dropped
+*/
+template<typename DequeType>
+struct StealingData
+{
+    DequeType *Deques; // one deque per work-group
+    int NumQueues;
+    int NumTasks; // number of initial tasks, split evenly over the deques
+    int *TasksLeft; // set to the total number of tasks before launch
+    bool EnableStealing; // false gives plain static partitioning
+    const int *InitialTasks = nullptr; // optional device list of initial task ids, e.g. DAG roots
+    int *Overflow = nullptr; // optional, set to 0 before launch, nonzero once a task was dropped
+};
+
+template<std::size_t WorkGroupSize, typename DequeType, typename TaskType>
+sycl::event stealing_execute(sycl::queue &Q, StealingData<DequeType> Data, TaskType Task)
+{
+    const std::size_t GlobalSize = Data.NumQueues * WorkGroupSize;
+    const int TasksPerQueue = (Data.NumTasks + Data.NumQueues - 1) / Data.NumQueues;
+
+    return Q.submit([&](sycl::handler &h)
+    {
+        sycl::local_accessor<int, 1> Batch(sycl::range<1>{WorkGroupSize}, h);
+        sycl::local_accessor<int, 1> BatchSize(sycl::range<1>{1}, h);
+
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{GlobalSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            int ID = Item.get_local_id(0);
+            int QueueIdx = Item.get_group_linear_id();
+            auto &OwnDeque = Data.Deques[QueueIdx];
+
+            sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                sycl::access::address_space::global_space> TasksLeft(*Data.TasksLeft);
+
+            // Only the master tracks the initial tasks still waiting for a free slot
+            int NextTask = QueueIdx * TasksPerQueue;
+            int LastTask = std::min(NextTask + TasksPerQueue, Data.NumTasks);
+
+            // xorshift state for victim selection, only used by the master
+            unsigned int Seed = QueueIdx * 2654435761u + 1;
+
+            while (true)
+            {
+                if (ID == 0)
+                {
+                    while (NextTask < LastTask && OwnDeque.push(Data.InitialTasks ? Data.InitialTasks[NextTask] : NextTask))
+                    {
+                        NextTask++;
+                    }
+
+                    int Count = 0;
+                    int TaskId;
+                    while (Count < static_cast<int>(WorkGroupSize) && OwnDeque.pop(TaskId))
+                    {
+                        Batch[Count++] = TaskId;
+                    }
+
+                    if (Count == 0 && Data.EnableStealing && Data.NumQueues > 1)
+                    {
+                        for (int Attempt = 0; Attempt < Data.NumQueues && Count == 0; Attempt++)
+                        {
+                            Seed ^= Seed << 13;
+                            Seed ^= Seed >> 17;
+                            Seed ^= Seed << 5;
+                            int Victim = Seed % Data.NumQueues;
+                            if (Victim == QueueIdx)
+                            {
+                                continue;
+                            }
+
+                            auto &VictimDeque = Data.Deques[Victim];
+                            int Half = std::min(static_cast<int>(WorkGroupSize), (VictimDeque.size() + 1) / 2);
+                            while (Count < Half && VictimDeque.steal(TaskId))
+                            {
+                                Batch[Count++] = TaskId;
+                            }
+                        }
+                    }
+
+                    // Without stealing a group is done as soon as its own deque is
+                    bool Dropped = Data.Overflow && sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                        sycl::access::address_space::global_space>(*Data.Overflow).load() != 0;
+                    if (Dropped || (Count == 0 && NextTask >= LastTask && (!Data.EnableStealing || TasksLeft.load() == 0)))
+                    {
+                        Count = -1;
+                    }
+                    BatchSize[0] = Count;
+                }
+
+                sycl::group_barrier(Group);
+
+                int Count = BatchSize[0];
+                if (Count < 0)
+                {
+                    break;
+                }
+
+                if (ID < Count)
+                {
+                    Task.execute(Batch[ID]);
+                }
+
+                sycl::group_barrier(Group);
+
+                if (ID == 0 && Count > 0)
+                {
+                    for (int i = 0; i < Count; i++)
+                    {
+                        Task.solve_dependencies(Batch[i], OwnDeque);
+                    }
+                    TasksLeft.fetch_sub(Count);
+                }
+            }
+        });
+    });
+}
+
+/*
+    Sub-group granular dispatch, no work-group barriers
+    - Sub-groups repeatedly claim a batch of tasks with a single atomic on
+      NextBatch, the batch id is spread with group_broadcast
+    - Batches are get_max_local_range() tasks long, the same for every
+      sub-group of the work-group; each lane executes every
+      get_local_linear_range()-th task of the batch, so a smaller tail
+      sub-group simply takes more than one task per lane
+    - Tasks run straight from the batch, no queue between claim and execute,
+      the broadcast is the only sub-group collective per batch
+    - solve_dependencies is not called, tasks must be independent
+*/
+struct SubGroupData
+{
+    int NumTasks; // tasks 0..NumTasks-1
+    int *NextBatch; // set to 0 before launch
+};
+
+template<typename TaskType>
+class SubGroupKernel;
+
+template<typename TaskType>
+sycl::event subgroup_execute(sycl::queue &Q, SubGroupData Data, sycl::nd_range<1> Range, TaskType Task)
+{
+    return Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for<SubGroupKernel<TaskType>>(Range, [=](sycl::nd_item<1> Item)
+        {
+            sycl::sub_group SubGroup = Item.get_sub_group();
+            int Lane = SubGroup.get_local_linear_id();
+            int SubGroupSize = SubGroup.get_local_linear_range();
+            int BatchStride = SubGroup.get_max_local_range()[0];
+
+            sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                sycl::access::address_space::global_space> NextBatch(*Data.NextBatch);
+
+            while (true)
+            {
+                int Batch = 0;
+                if (Lane == 0)
+                {
+                    Batch = NextBatch.fetch_add(1);
+                }
+                Batch = sycl::group_broadcast(SubGroup, Batch, 0);
+
+                int FirstTask = Batch * BatchStride;
+                if (FirstTask >= Data.NumTasks)
+                {
+                    break;
+                }
+
+                for (int Offset = Lane; Offset < BatchStride && FirstTask + Offset < Data.NumTasks; Offset += SubGroupSize)
+                {
+                    Task.execute(FirstTask + Offset);
+                }
+            }
+        });
+    });
+}
+#endif
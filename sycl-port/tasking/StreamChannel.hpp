@@ -0,0 +1,170 @@
+#ifndef __STREAM_CHANNEL_H__
+#define __STREAM_CHANNEL_H__
+
+#include <algorithm>
+#include <thread>
+#include <CL/sycl.hpp>
+
+/*
+    Host-to-device streaming channel
+    - FIFO ring of maxSize slots, placed in malloc_shared or malloc_host memory
+      so host threads can keep pushing while a consumer kernel is running
+    - SPMCArrayQueue roles: the host is the producer side (back = m_published),
+      device work-groups consume from the front (m_consumed)
+    - Several host threads may push: each claims a ticket, waits for its slot to
+      be free, writes it and publishes strictly in ticket order, so consumers
+      only ever see a gap-free prefix of published slots
+    - Consumers poll m_published as a doorbell and claim a batch with one CAS
+      on m_consumed, reading the slots before the claim; a slot is only
+      overwritten once m_consumed has moved past it, so a failed CAS just
+      discards the copies
+    - close() is the last doorbell: consumers leave once everything published
+      has been claimed
+    - Indices are system-scope atomics, the device must support them
+      (CPU devices and shared allocations on recent GPUs do)
+*/
+template<typename valueType, int maxSize>
+class StreamChannel
+{
+    using atomicIndex = sycl::atomic_ref<
+            int,
+            sycl::memory_order::relaxed,
+            sycl::memory_scope::system>;
+
+    public:
+        StreamChannel() : m_reserved(0), m_published(0), m_consumed(0), m_closed(0)
+        {
+        };
+        ~StreamChannel()
+        {
+        };
+
+        /*
+            Host side, spins while the ring is full
+            Yields while waiting, producers often share cores with a CPU device
+        */
+        void push(const valueType &value)
+        {
+            int ticket = atomicIndex(m_reserved).fetch_add(1);
+            while (ticket - atomicIndex(m_consumed).load(sycl::memory_order::acquire) >= maxSize)
+            {
+                std::this_thread::yield();
+            }
+
+            m_elements[ticket % maxSize] = value;
+
+            // earlier tickets publish first
+            atomicIndex published(m_published);
+            while (published.load(sycl::memory_order::acquire) != ticket)
+            {
+                std::this_thread::yield();
+            }
+            published.store(ticket + 1, sycl::memory_order::release);
+        }
+
+        /*
+            Host side, call once every producer has returned from push
+        */
+        void close()
+        {
+            atomicIndex(m_closed).store(1, sycl::memory_order::release);
+        }
+
+        /*
+            Device side, copies up to n published elements to out
+            Returns the number claimed, 0 if none is ready (or another consumer
+            won the race) and -1 once the channel is closed and drained
+        */
+        int try_pop_n(valueType *out, int n)
+        {
+            atomicIndex consumed(m_consumed);
+            int front = consumed.load();
+
+            // closed is read first, so a closed channel's back is already final
+            bool closed = atomicIndex(m_closed).load(sycl::memory_order::acquire) != 0;
+            int back = atomicIndex(m_published).load(sycl::memory_order::acquire);
+
+            int count = std::min(n, back - front);
+            if (count <= 0)
+            {
+                return closed ? -1 : 0;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                out[i] = m_elements[(front + i) % maxSize];
+            }
+
+            if (consumed.compare_exchange_strong(front, front + count, sycl::memory_order::acq_rel, sycl::memory_order::relaxed))
+            {
+                return count;
+            }
+            return 0;
+        }
+
+        int sizeMax() const
+        {
+            return maxSize;
+        }
+
+    protected:
+        alignas(64) int m_reserved; // tickets handed out to producers
+        alignas(64) int m_published; // slots [0, m_published) are readable
+        alignas(64) int m_consumed; // slots [0, m_consumed) are claimed by consumers
+        alignas(64) int m_closed; // set by close()
+        valueType m_elements[maxSize];
+};
+
+/*
+    Persistent consumer loop over a channel of int task ids
+    - The master of each work-group polls the channel and claims up to
+      WorkGroupSize tasks, the whole group executes them
+    - Runs until the channel is closed and drained, so launch only groups that
+      leave cores free for the host producers
+*/
+template<std::size_t WorkGroupSize, typename ChannelType, typename TaskType>
+sycl::event stream_execute(sycl::queue &Q, ChannelType *Channel, std::size_t NumWorkGroups, TaskType Task)
+{
+    const std::size_t GlobalSize = NumWorkGroups * WorkGroupSize;
+
+    return Q.submit([&](sycl::handler &h)
+    {
+        sycl::local_accessor<int, 1> Batch(sycl::range<1>{WorkGroupSize}, h);
+        sycl::local_accessor<int, 1> BatchSize(sycl::range<1>{1}, h);
+
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{GlobalSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            int ID = Item.get_local_id(0);
+
+            while (true)
+            {
+                if (ID == 0)
+                {
+                    int Count;
+                    while ((Count = Channel->try_pop_n(&Batch[0], WorkGroupSize)) == 0)
+                    {
+                    }
+                    BatchSize[0] = Count;
+                }
+
+                sycl::group_barrier(Group);
+
+                int Count = BatchSize[0];
+                if (Count < 0)
+                {
+                    break;
+                }
+
+                if (ID < Count)
+                {
+                    Task.execute(Batch[ID]);
+                }
+
+                sycl::group_barrier(Group);
+            }
+        });
+    });
+}
+
+#endif
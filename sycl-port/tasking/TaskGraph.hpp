@@ -0,0 +1,208 @@
+#ifndef __TASK_GRAPH_H__
+#define __TASK_GRAPH_H__
+
+#include <algorithm>
+#include <vector>
+#include <CL/sycl.hpp>
+
+/*
+    Task dependency DAG in device USM
+    - Successor lists stored CSR style: successors of task i are
+      Successors[RowOffsets[i] .. RowOffsets[i + 1])
+    - Pending holds the remaining in-degree of every task and is decremented
+      atomically as predecessors finish, the predecessor that brings it to
+      zero pushes the task onto its queue
+    - If that queue is full the task is dropped and Overflow is set; pass it
+      as StealingData::Overflow so the scheduler stops instead of waiting
+*/
+struct TaskGraph
+{
+    int NumTasks;
+    int NumEdges;
+    int *RowOffsets;
+    int *Successors;
+    int *InDegree; // initial in-degree, kept so the graph can be replayed
+    int *Pending; // remaining in-degree
+    int *Overflow; // nonzero once a ready task did not fit its queue
+
+    /*
+        Called once per finished task by the work-item that owns Queue
+    */
+    template<typename Queue>
+    void release_successors(int TaskId, Queue &TaskQueue) const
+    {
+        for (int e = RowOffsets[TaskId]; e < RowOffsets[TaskId + 1]; e++)
+        {
+            int Successor = Successors[e];
+            sycl::atomic_ref<int, sycl::memory_order::acq_rel, sycl::memory_scope::device,
+                sycl::access::address_space::global_space> Remaining(Pending[Successor]);
+            if (Remaining.fetch_sub(1) == 1)
+            {
+                // only the owner pushes, so a queue below sizeMax() has room
+                if (TaskQueue.size() < TaskQueue.sizeMax())
+                {
+                    TaskQueue.push(Successor);
+                }
+                else
+                {
+                    sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device,
+                        sycl::access::address_space::global_space>(*Overflow).store(1);
+                }
+            }
+        }
+    }
+};
+
+/*
+    Build a graph from host adjacency lists, SuccessorLists[i] being the tasks that depend on i
+*/
+TaskGraph make_task_graph(sycl::queue &Q, const std::vector<std::vector<int>> &SuccessorLists)
+{
+    TaskGraph Graph;
+    Graph.NumTasks = SuccessorLists.size();
+
+    std::vector<int> HostOffsets(Graph.NumTasks + 1, 0);
+    std::vector<int> HostInDegree(Graph.NumTasks, 0);
+    std::vector<int> HostSuccessors;
+    for (int i = 0; i < Graph.NumTasks; i++)
+    {
+        for (int Successor : SuccessorLists[i])
+        {
+            HostSuccessors.push_back(Successor);
+            HostInDegree[Successor] += 1;
+        }
+        HostOffsets[i + 1] = HostSuccessors.size();
+    }
+    Graph.NumEdges = HostSuccessors.size();
+
+    Graph.RowOffsets = sycl::malloc_device<int>(Graph.NumTasks + 1, Q);
+    Graph.Successors = sycl::malloc_device<int>(std::max(Graph.NumEdges, 1), Q);
+    Graph.InDegree = sycl::malloc_device<int>(Graph.NumTasks, Q);
+    Graph.Pending = sycl::malloc_device<int>(Graph.NumTasks, Q);
+    Graph.Overflow = sycl::malloc_device<int>(1, Q);
+
+    Q.memcpy(Graph.RowOffsets, HostOffsets.data(), HostOffsets.size() * sizeof(int));
+    Q.memcpy(Graph.Successors, HostSuccessors.data(), HostSuccessors.size() * sizeof(int));
+    Q.memcpy(Graph.InDegree, HostInDegree.data(), HostInDegree.size() * sizeof(int));
+    Q.memcpy(Graph.Pending, HostInDegree.data(), HostInDegree.size() * sizeof(int));
+    Q.fill(Graph.Overflow, 0, 1);
+    Q.wait();
+
+    return Graph;
+}
+
+/*
+    Restore every in-degree counter and clear the overflow flag so the graph can run again
+*/
+sycl::event reset_task_graph(sycl::queue &Q, const TaskGraph &Graph)
+{
+    sycl::event ClearEvent = Q.fill(Graph.Overflow, 0, 1);
+    return Q.memcpy(Graph.Pending, Graph.InDegree, Graph.NumTasks * sizeof(int), ClearEvent);
+}
+
+/*
+    True if the last run dropped a ready task because its queue was full
+*/
+bool task_graph_overflowed(sycl::queue &Q, const TaskGraph &Graph)
+{
+    int HostOverflow = 0;
+    Q.memcpy(&HostOverflow, Graph.Overflow, sizeof(int));
+    Q.wait();
+    return HostOverflow != 0;
+}
+
+void free_task_graph(sycl::queue &Q, TaskGraph &Graph)
+{
+    sycl::free(Graph.RowOffsets, Q);
+    sycl::free(Graph.Successors, Q);
+    sycl::free(Graph.InDegree, Q);
+    sycl::free(Graph.Pending, Q);
+    sycl::free(Graph.Overflow, Q);
+}
+
+/*
+    Host helper: tasks with no predecessors
+*/
+std::vector<int> graph_roots(const std::vector<std::vector<int>> &SuccessorLists)
+{
+    std::vector<int> InDegree(SuccessorLists.size(), 0);
+    for (const auto &Successors : SuccessorLists)
+    {
+        for (int Successor : Successors)
+        {
+            InDegree[Successor] += 1;
+        }
+    }
+
+    std::vector<int> Roots;
+    for (std::size_t i = 0; i < InDegree.size(); i++)
+    {
+        if (InDegree[i] == 0) Roots.push_back(i);
+    }
+    return Roots;
+}
+
+/*
+    Host helper: bottom level of every task, the number of tasks on the
+    longest path from it to a sink, itself included; tasks on the critical
+    path have the largest values
+*/
+std::vector<int> bottom_levels(const std::vector<std::vector<int>> &SuccessorLists)
+{
+    const int NumTasks = SuccessorLists.size();
+    std::vector<int> InDegree(NumTasks, 0);
+    for (const auto &Successors : SuccessorLists)
+    {
+        for (int Successor : Successors)
+        {
+            InDegree[Successor] += 1;
+        }
+    }
+
+    // topological order, then successors before predecessors
+    std::vector<int> Order;
+    for (int i = 0; i < NumTasks; i++)
+    {
+        if (InDegree[i] == 0) Order.push_back(i);
+    }
+    for (std::size_t k = 0; k < Order.size(); k++)
+    {
+        for (int Successor : SuccessorLists[Order[k]])
+        {
+            if (--InDegree[Successor] == 0) Order.push_back(Successor);
+        }
+    }
+
+    std::vector<int> Levels(NumTasks, 1);
+    for (auto it = Order.rbegin(); it != Order.rend(); ++it)
+    {
+        for (int Successor : SuccessorLists[*it])
+        {
+            Levels[*it] = std::max(Levels[*it], Levels[Successor] + 1);
+        }
+    }
+    return Levels;
+}
+
+/*
+    Scheduler task type running Body over a TaskGraph, newly ready tasks
+    are pushed onto the queue of the work-group that released them
+*/
+template<typename BodyType>
+struct GraphTask
+{
+    TaskGraph Graph;
+    BodyType Body;
+
+    void execute(int TaskId) const
+    {
+        Body(TaskId);
+    }
+
+    template<typename Queue>
+    void solve_dependencies(int TaskId, Queue &TaskQueue) const
+    {
+        Graph.release_successors(TaskId, TaskQueue);
+    }
+};
+#endif
@@ -0,0 +1,127 @@
+#ifndef __TASK_RECORD_H__
+#define __TASK_RECORD_H__
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <CL/sycl.hpp>
+#include "Scheduler.hpp"
+
+/*
+    Typed task records
+    - One cache line per task: an opcode plus an inline argument block,
+      so queues and task tables can carry mixed task kinds by value
+    - Task kinds are listed at compile time in a TaskKinds<...> type list,
+      the opcode of a kind is its position in the list
+    - Kernels cannot make virtual calls, dispatch_task expands the list into
+      a chain of opcode comparisons instead, any number of kinds
+
+    KindType must provide:
+        struct Args; // trivially copyable, at most TaskRecord::ArgBytes bytes
+        static void execute(const Args &A);
+*/
+struct alignas(64) TaskRecord
+{
+    static constexpr std::size_t ArgBytes = 56;
+
+    int Opcode;
+    alignas(8) unsigned char Args[ArgBytes];
+};
+
+static_assert(sizeof(TaskRecord) == 64, "TaskRecord must fill exactly one cache line");
+
+template<typename... Kinds>
+struct TaskKinds
+{
+    static constexpr int Count = sizeof...(Kinds);
+};
+
+/*
+    Position of Kind in the list, a compile error if it is not registered
+*/
+template<typename Kind, typename List>
+struct task_opcode;
+
+template<typename Kind, typename... Rest>
+struct task_opcode<Kind, TaskKinds<Kind, Rest...>> : std::integral_constant<int, 0>
+{
+};
+
+template<typename Kind, typename First, typename... Rest>
+struct task_opcode<Kind, TaskKinds<First, Rest...>> : std::integral_constant<int, 1 + task_opcode<Kind, TaskKinds<Rest...>>::value>
+{
+};
+
+template<int Index, typename List>
+struct task_kind;
+
+template<typename First, typename... Rest>
+struct task_kind<0, TaskKinds<First, Rest...>>
+{
+    using type = First;
+};
+
+template<int Index, typename First, typename... Rest>
+struct task_kind<Index, TaskKinds<First, Rest...>>
+{
+    using type = typename task_kind<Index - 1, TaskKinds<Rest...>>::type;
+};
+
+/*
+    Host side, pack the arguments of a registered kind into a record
+*/
+template<typename Kind, typename List>
+TaskRecord make_task_record(const typename Kind::Args &A)
+{
+    static_assert(std::is_trivially_copyable<typename Kind::Args>::value, "Task arguments must be trivially copyable");
+    static_assert(sizeof(typename Kind::Args) <= TaskRecord::ArgBytes, "Task arguments do not fit in a TaskRecord");
+
+    TaskRecord Record{};
+    Record.Opcode = task_opcode<Kind, List>::value;
+    std::memcpy(Record.Args, &A, sizeof(A));
+    return Record;
+}
+
+template<int Index, typename List>
+void execute_task_kind(const TaskRecord &Record)
+{
+    using Kind = typename task_kind<Index, List>::type;
+    typename Kind::Args A;
+    std::memcpy(&A, Record.Args, sizeof(A));
+    Kind::execute(A);
+}
+
+/*
+    One comparison per registered kind, expanded from the list and
+    stopping at the match, the optimiser is free to turn it into a switch;
+    unknown opcodes are ignored
+*/
+template<typename List, int... Index>
+void dispatch_task(const TaskRecord &Record, std::integer_sequence<int, Index...>)
+{
+    (void)((Record.Opcode == Index && (execute_task_kind<Index, List>(Record), true)) || ...);
+}
+
+template<typename List>
+void dispatch_task(const TaskRecord &Record)
+{
+    static_assert(List::Count > 0, "dispatch_task needs at least one task kind");
+    dispatch_task<List>(Record, std::make_integer_sequence<int, List::Count>{});
+}
+
+/*
+    Scheduler task over a device table of records, the queues keep
+    carrying int ids that index the table
+*/
+template<typename List>
+struct RecordTask : IndependentTask
+{
+    const TaskRecord *Records;
+
+    void execute(int TaskId) const
+    {
+        dispatch_task<List>(Records[TaskId]);
+    }
+};
+
+#endif
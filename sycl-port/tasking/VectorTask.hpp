@@ -0,0 +1,110 @@
+#ifndef __VECTOR_TASK_H__
+#define __VECTOR_TASK_H__
+
+#include <algorithm>
+#include <CL/sycl.hpp>
+#include "GrainSize.hpp"
+
+/*
+    Vectorized range tasks
+    - A task still covers [k * Grain, min((k + 1) * Grain, NumElements)), but
+      Grain is a multiple of the lane count N, so every block starts on an
+      N-element boundary of the (USM aligned) arrays
+    - The body works on sycl::vec<int, N> loads and stores instead of one
+      element per call, which is what CPU backends need to emit SIMD code
+    - The last task of a range that is not a multiple of N finishes on the
+      scalar path
+*/
+constexpr int MaxVectorWidth = 16;
+
+/*
+    Lane count for int on this device, preferred_vector_width_int rounded
+    down to a width sycl::vec supports (1, 2, 4, 8 or 16)
+*/
+inline int vector_width(const sycl::device &Device)
+{
+    int Preferred = Device.get_info<sycl::info::device::preferred_vector_width_int>();
+    int Width = 1;
+    while (Width * 2 <= std::min(Preferred, MaxVectorWidth))
+    {
+        Width *= 2;
+    }
+    return Width;
+}
+
+/*
+    Grain rounded up to whole vectors
+*/
+inline int vector_grain(int Grain, int Width)
+{
+    return (std::max(Grain, 1) + Width - 1) / Width * Width;
+}
+
+template<int N, typename T>
+sycl::vec<T, N> load_lanes(const T *Data, int Begin)
+{
+    sycl::vec<T, N> Lanes;
+    Lanes.load(0, sycl::address_space_cast<sycl::access::address_space::global_space, sycl::access::decorated::no>(Data + Begin));
+    return Lanes;
+}
+
+template<int N, typename T>
+void store_lanes(const sycl::vec<T, N> &Lanes, T *Data, int Begin)
+{
+    Lanes.store(0, sycl::address_space_cast<sycl::access::address_space::global_space, sycl::access::decorated::no>(Data + Begin));
+}
+
+/*
+    BodyType must provide:
+        void operator()(int Element) const;       // scalar tail
+        template<int N> void lanes(int Begin) const; // elements [Begin, Begin + N)
+*/
+template<int N, typename BodyType>
+struct VectorRangeTask : IndependentTask
+{
+    BodyType Body;
+    int NumElements;
+    int Grain; // multiple of N
+
+    void execute(int TaskId) const
+    {
+        TaskRange Range = task_range(TaskId, Grain, NumElements);
+        int End = Range.Begin + Range.Length;
+        int i = Range.Begin;
+        for (; i + N <= End; i += N)
+        {
+            Body.template lanes<N>(i);
+        }
+        for (; i < End; i++)
+        {
+            Body(i);
+        }
+    }
+};
+
+template<std::size_t WorkGroupSize, int N, typename QueueType, typename BodyType>
+sycl::event vector_range_execute(sycl::queue &Q, QueueType *Queues, int NumQueues, int NumElements, int Grain, BodyType Body)
+{
+    int VectorGrain = vector_grain(Grain, N);
+    InitData<QueueType> Data{Queues, NumQueues, num_range_tasks(NumElements, VectorGrain)};
+    return persistent_execute<WorkGroupSize>(Q, Data, VectorRangeTask<N, BodyType>{{}, Body, NumElements, VectorGrain});
+}
+
+/*
+    Persistent scheduler over NumElements elements with Width lanes per step
+    - Width comes from vector_width(), each supported width is its own kernel
+*/
+template<std::size_t WorkGroupSize, typename QueueType, typename BodyType>
+sycl::event vector_range_execute(sycl::queue &Q, QueueType *Queues, int NumQueues, int NumElements, int Grain, int Width, BodyType Body)
+{
+    switch (Width)
+    {
+        case 16: return vector_range_execute<WorkGroupSize, 16>(Q, Queues, NumQueues, NumElements, Grain, Body);
+        case 8: return vector_range_execute<WorkGroupSize, 8>(Q, Queues, NumQueues, NumElements, Grain, Body);
+        case 4: return vector_range_execute<WorkGroupSize, 4>(Q, Queues, NumQueues, NumElements, Grain, Body);
+        case 2: return vector_range_execute<WorkGroupSize, 2>(Q, Queues, NumQueues, NumElements, Grain, Body);
+        default: return vector_range_execute<WorkGroupSize, 1>(Q, Queues, NumQueues, NumElements, Grain, Body);
+    }
+}
+
+#endif
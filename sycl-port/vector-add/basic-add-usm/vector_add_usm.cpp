@@ -1,37 +1,18 @@
 #include "../../sycl_utils.hpp"
+#include "../../device_arena.hpp"
 #include "../va_profiler.cpp"
+#include "../va_tracer.cpp"
+#include "../va_verify.cpp"
 
-int main(int argc, char **argv)
+bool basic_usm_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
 {
-    if (argc != 2)
-    {
-        std::cerr << "Usage: " << argv[0] << " <Vector Size>" << "\n";
-        return 1;
-    }
-
-    std::size_t VecSize = std::atoi(argv[1]);
-    if (VecSize <= 0) {
-        std::cerr << "Invalid vector size: " << argv[1] << std::endl;
-        return 1;
-    }
-
-    sycl::default_selector device_selector;
-    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
-
-    sycl::queue Q(device_selector, props);
-    sycl::device Device = Q.get_device();
-
-    auto DevName = Device.get_info<sycl::info::device::name>();
-    // ------------------------
-    // PROFILING
-    // ------------------------
-
     auto StartTimePoint = std::chrono::high_resolution_clock::now();
 
-    int *A = sycl::malloc_device<int>(VecSize, Q);
-    int *B = sycl::malloc_device<int>(VecSize, Q);
-    int *R = sycl::malloc_device<int>(VecSize, Q);
-    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
         A[idx] = 1;
         B[idx] = 0;
         R[idx] = 0;
@@ -51,17 +32,6 @@ int main(int argc, char **argv)
 
     auto EndTimePoint = std::chrono::high_resolution_clock::now();
 
-    // bring mem over to check correctness
-    // int hostR[VecSize];
-    // Q.memcpy(hostR, R, VecSize * sizeof(int));
-    // Q.wait();
-
-    // std::cout << "Checking correctness:" << "\n";
-    // bool CorrectAdd = check_vector_add(hostR, VecSize);
-    // std::cout << "Vector Addition for size: " << VecSize << "\n";
-    // std::cout << "Correct? " << std::boolalpha << CorrectAdd << std::endl;
-
-
     durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
     durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
 
@@ -69,13 +39,72 @@ int main(int argc, char **argv)
     auto EndKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
     double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
 
-    std::cout << "Total Exec Time" << "," << ExecTime.count() << "," << VecSize << "\n";
-    std::cout << "Memory Setup Time" << "," << MemTime.count() << "," << VecSize << "\n";
-    std::cout << "Kernel Exec Time" << "," << KernelProfileTime << "," << VecSize << "\n";
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count()});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count()});
+    Events.push_back({"Kernel Exec Time", VecSize, KernelProfileTime});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Add Kernel", AddEvent);
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, 0, "usm", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+#ifndef VA_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Vector Size>" << "\n";
+        return 1;
+    }
+
+    std::size_t VecSize = std::atoi(argv[1]);
+    if (VecSize <= 0) {
+        std::cerr << "Invalid vector size: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+
+    auto DevName = Device.get_info<sycl::info::device::name>();
+
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(VecSize) + verify_footprint());
+
+    // ------------------------
+    // PROFILING
+    // ------------------------
+
+    std::vector<TimingEvent> Events;
+
+    bool IsCorrect;
+    try
+    {
+        IsCorrect = basic_usm_add(Q, Arena, VecSize, Events);
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
 
-    sycl::free(A, Q);
-    sycl::free(B, Q);
-    sycl::free(R, Q);
+    // Rows follow TimingReport::csv_header(), the run scripts write the header once
+    TimingReport Report(DevName);
+    Report.add("usm", Events);
+    Report.write_csv(std::cout, false);
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
     
-    return 0;
+    return IsCorrect ? 0 : 1;
 }
+#endif
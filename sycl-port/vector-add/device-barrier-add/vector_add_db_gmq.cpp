@@ -0,0 +1,182 @@
+#include <CL/sycl.hpp>
+#include "../../sycl_utils.hpp"
+#include "../../device_arena.hpp"
+#include "../../tasking/DeviceBarrier.hpp"
+#include "../../tasking/RingQueue.hpp"
+#include "../va_profiler.cpp"
+#include "../va_tracer.cpp"
+#include "../va_verify.cpp"
+#include "../va_autotune.cpp"
+
+/*
+    Split-kernel GMQ phases (enqueue, add, shutdown) fused into one persistent
+    kernel, separated by device-wide barriers instead of Q.wait()
+    - Only as many work-groups as can be co-resident are launched, each walks
+      over the queues QueueIdx = group, group + NumGroups, ...
+    - Every phase touches only the group's own queues, as in split and sk;
+      cross-group visibility of the barrier is checked by device_barrier_bench
+*/
+bool db_multi_queue_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
+{
+    const size_t NumQueues = VecSize / WorkGroupSize;
+    if (NumQueues % 2 != 0 && NumQueues != 1)
+    {
+        std::cerr << "Number of work groups should divide Vector Size evenly!" << "\n";
+        return false;
+    }
+
+    sycl::nd_range<1> Range = persistent_range(Q.get_device(), WorkGroupSize, NumQueues);
+    const int NumGroups = Range.get_group_range()[0];
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    // Queues are constructed in parallel, one work-item per queue
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumQueues, WorkGroupSize);
+    auto TaskQueues = QueueSet.Queues;
+    DeviceBarrier *Barrier = Arena.allocate<DeviceBarrier>(1);
+
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    sycl::event BarrierEvent = Q.single_task([=]()
+    {
+        new (Barrier) DeviceBarrier(NumGroups);
+    });
+    Q.wait();
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    sycl::event AddEvent = Q.submit([&](sycl::handler &h)
+    {
+        h.parallel_for(Range, [=](sycl::nd_item<1> Item)
+        {
+            sycl::group Group = Item.get_group();
+            int GroupIdx = Item.get_group_linear_id();
+            int LocalId = Item.get_local_id(0);
+
+            for (std::size_t QueueIdx = GroupIdx; QueueIdx < NumQueues; QueueIdx += NumGroups)
+            {
+                TaskQueues[QueueIdx].group_push(Group, static_cast<int>(QueueIdx * WorkGroupSize) + LocalId);
+            }
+
+            Barrier->wait(Group);
+
+            for (std::size_t QueueIdx = GroupIdx; QueueIdx < NumQueues; QueueIdx += NumGroups)
+            {
+                int ItemVal = TaskQueues[QueueIdx].front(LocalId);
+                R[ItemVal] = A[ItemVal] + B[ItemVal];
+            }
+
+            Barrier->wait(Group);
+
+            for (std::size_t QueueIdx = GroupIdx; QueueIdx < NumQueues; QueueIdx += NumGroups)
+            {
+                TaskQueues[QueueIdx].group_pop(Group, WorkGroupSize);
+            }
+        });
+    });
+    Q.wait();
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now(); 
+
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
+
+    auto StartKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Kernel Exec Time", VecSize, KernelProfileTime, WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Barrier Construction", BarrierEvent);
+        Tracer->device("Fused Kernel", AddEvent);
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "db", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+#ifndef VA_BENCH_DRIVER
+int main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Vector Size> [Work Group Size]" << "\n";
+        return 1;
+    }
+
+    std::size_t VecSize = std::atoi(argv[1]);
+    if (VecSize <= 0) {
+        std::cerr << "Invalid vector size: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+
+    auto DevName = Device.get_info<sycl::info::device::name>();
+
+    std::size_t WorkGroupSize = 32;
+    if (argc == 3)
+    {
+        WorkGroupSize = std::atoi(argv[2]);
+    }
+
+    auto MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+    if (WorkGroupSize > MaxGroupSize)
+    {
+        std::cerr << "Work Group Size cannot exceed " << MaxGroupSize << " on this device!" << "\n";
+        return 1;
+    }
+    if (!valid_work_group_size(VecSize, WorkGroupSize, MaxGroupSize))
+    {
+        std::cerr << "Work Group Size must divide Vector Size into one or an even number of work groups" << "\n";
+        return 1;
+    }
+
+    std::size_t NumQueues = VecSize / WorkGroupSize;
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(VecSize) + ring_queues_footprint<int>(NumQueues, WorkGroupSize)
+                         + DeviceArena::footprint<DeviceBarrier>(1) + verify_footprint());
+
+    std::vector<TimingEvent> Events;
+
+    bool IsCorrect;
+    try
+    {
+        IsCorrect = db_multi_queue_add(Q, Arena, VecSize, WorkGroupSize, Events);
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    // Rows follow TimingReport::csv_header(), the run scripts write the header once
+    TimingReport Report(DevName);
+    Report.add("db", Events);
+    Report.write_csv(std::cout, false);
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
+
+    return IsCorrect ? 0 : 1;
+}
+#endif
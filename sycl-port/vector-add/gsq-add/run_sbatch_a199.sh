@@ -13,15 +13,16 @@ module load cuda/11.5 llvm-clang
 # clang++ -Wall -fsycl -fsycl-targets=nvptx64-nvidia-cuda vector_add_gsq.cpp
 
 if [ ! -s "${output_file}" ]; then
-    echo "Event,ExecTime(ms),VectorSize" >> $output_file
+    echo "Variant,Event,VectorSize,WorkGroupSize,Device,Samples,Min(ms),Median(ms),Mean(ms),P95(ms),P99(ms),StdDev(ms),Elements/s,GB/s" >> $output_file
 fi
 
 for ((j=10; j < 30; j++))
 do
-    ./${j}
+    vector_size=$((2**$j))
+    ./a.out $vector_size
     for ((i=0; i < 30; i++))
         do
-            ./${j} >> $output_file
+            ./a.out $vector_size >> $output_file
         done
 done
 
@@ -1,28 +1,33 @@
 #include <CL/sycl.hpp>
 #include "../../sycl_utils.hpp"
-#include "../../tasking/ArrayQueue.cpp"
+#include "../../device_arena.hpp"
+#include "../../tasking/RingQueue.hpp"
 #include "../va_profiler.cpp"
+#include "../va_tracer.cpp"
+#include "../va_verify.cpp"
 
-template<std::size_t VecSize>
-void single_queue_add(sycl::queue &Q, std::vector<TimingEvent> &Events)
+bool single_queue_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
 {
     auto StartTimePoint = std::chrono::high_resolution_clock::now();
 
-    auto TaskQueue = sycl::malloc_device<SPMCArrayQueue<int, VecSize>>(1, Q);
+    auto QueueSet = make_ring_queues<int>(Q, Arena, 1, VecSize);
+    auto TaskQueue = QueueSet.Queues;
 
-    int *A = sycl::malloc_device<int>(VecSize, Q);
-    int *B = sycl::malloc_device<int>(VecSize, Q);
-    int *R = sycl::malloc_device<int>(VecSize, Q);
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
 
-    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
         A[idx] = 1;
         B[idx] = 0;
         R[idx] = 0;
     });
     Q.wait();
-    Q.single_task([=]()
+    sycl::event ReserveEvent = Q.single_task([=]()
         {
-            new (TaskQueue) SPMCArrayQueue<int, VecSize>();
+            // Reserve every slot once so the enqueue kernel can fill them in parallel
+            TaskQueue->reserve(VecSize);
         }
     );
     Q.wait();
@@ -31,12 +36,9 @@ void single_queue_add(sycl::queue &Q, std::vector<TimingEvent> &Events)
 
     sycl::event EnqueueEvent = Q.submit([&](sycl::handler &h)
     {
-        h.single_task([=]()
+        h.parallel_for(VecSize, [=](sycl::id<1> idx)
         {
-            for (int i =0; i < VecSize; i++)
-            {
-                TaskQueue->push(i);
-            }
+            TaskQueue->slot(idx) = idx;
         });
     });
     Q.wait();
@@ -59,10 +61,7 @@ void single_queue_add(sycl::queue &Q, std::vector<TimingEvent> &Events)
     {
         h.single_task([=]()
         {
-            while (!TaskQueue->empty())
-            {
-                TaskQueue->pop();
-            }
+            TaskQueue->pop(TaskQueue->size());
         }); 
     });
     Q.wait();
@@ -90,18 +89,162 @@ void single_queue_add(sycl::queue &Q, std::vector<TimingEvent> &Events)
     Events.push_back({"Add Kernel Exec Time", VecSize, AddKernelProfileTime});
     Events.push_back({"Shutdown Kernel Exec Time", VecSize, ShutdownKernelProfileTime});
 
-    // bool CorrectAdd = check_vector_add(R, VecSize);
-    // std::cout << "Vector Addition for size: " << VecSize << "\n";
-    // std::cout << "Correct? " << std::boolalpha << CorrectAdd << std::endl;
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Reserve Kernel", ReserveEvent);
+        Tracer->device("Enqueue Kernel", EnqueueEvent);
+        Tracer->device("Add Kernel", AddEvent);
+        Tracer->device("Shutdown Kernel", ShutdownEvent);
+    }
 
-    sycl::free(TaskQueue, Q);
-    sycl::free(A, Q);
-    sycl::free(B, Q);
-    sycl::free(R, Q);
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, 0, "gsq", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
 }
 
+/*
+    Stream of batches over the single global queue
+    - VecSize elements are processed in batches of BatchSize, every batch runs
+      reserve -> enqueue -> add -> shutdown on one of two queues in turn
+    - Pipelined chains the phases with depends_on only and waits once at the end,
+      so batch k+1 is enqueued while batch k is still executing
+    - Otherwise every phase is followed by Q.wait(), as in single_queue_add
+    - Batch Stream Time starts before the A/B/R init kernel in both modes,
+      pipelined runs overlap it with the first batches
+*/
+bool single_queue_batched_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t BatchSize, bool Pipelined,
+    std::vector<TimingEvent> &Events, EventTracer *Tracer = nullptr)
+{
+    const std::size_t NumBatches = (VecSize + BatchSize - 1) / BatchSize;
+    const std::size_t NumQueues = std::min<std::size_t>(2, NumBatches);
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumQueues, BatchSize);
+    auto TaskQueues = QueueSet.Queues;
+
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    if (!Pipelined) Q.wait();
+
+    // last shutdown per queue, a queue is only reused once its previous batch drained
+    std::vector<sycl::event> QueueFree(NumQueues);
+    std::vector<std::pair<std::string, sycl::event>> BatchCommands; // for the tracer
+
+    for (std::size_t Batch = 0; Batch < NumBatches; Batch++)
+    {
+        auto TaskQueue = TaskQueues + Batch % NumQueues;
+        const std::size_t Offset = Batch * BatchSize;
+        const std::size_t Size = std::min(BatchSize, VecSize - Offset);
+
+        sycl::event ReserveEvent = Q.submit([&](sycl::handler &h)
+        {
+            if (Batch >= NumQueues)
+            {
+                h.depends_on(QueueFree[Batch % NumQueues]);
+            }
+            h.single_task([=]()
+            {
+                TaskQueue->reserve(Size);
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        sycl::event EnqueueEvent = Q.submit([&](sycl::handler &h)
+        {
+            h.depends_on(ReserveEvent);
+            h.parallel_for(Size, [=](sycl::id<1> idx)
+            {
+                TaskQueue->slot(idx) = Offset + idx[0];
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        sycl::event AddEvent = Q.submit([&](sycl::handler &h)
+        {
+            h.depends_on({InitEvent, EnqueueEvent});
+            h.parallel_for(Size, [=](sycl::id<1> idx)
+            {
+                int itemVal = TaskQueue->front(idx);
+                R[itemVal] = A[itemVal] + B[itemVal];
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        QueueFree[Batch % NumQueues] = Q.submit([&](sycl::handler &h)
+        {
+            h.depends_on(AddEvent);
+            h.single_task([=]()
+            {
+                TaskQueue->pop(TaskQueue->size());
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        BatchCommands.push_back({"Reserve Kernel", ReserveEvent});
+        BatchCommands.push_back({"Enqueue Kernel", EnqueueEvent});
+        BatchCommands.push_back({"Add Kernel", AddEvent});
+        BatchCommands.push_back({"Shutdown Kernel", QueueFree[Batch % NumQueues]});
+    }
+    Q.wait();
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now();
+
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
+    durationMiliSecs StreamTime = EndTimePoint - MemorySetupTimePoint;
+
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count()});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count()});
+    Events.push_back({"Batch Stream Time", VecSize, StreamTime.count()});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host(Pipelined ? "Pipelined Batches" : "Batches", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        for (const auto &Command : BatchCommands)
+        {
+            Tracer->device(Command.first, Command.second);
+        }
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, 0, "gsq", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+#ifndef VA_BENCH_DRIVER
 int main(int argc, char **argv)
 {
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <Vector Size>" << "\n";
+        return 1;
+    }
+
+    std::size_t VecSize = std::atoi(argv[1]);
+    if (VecSize <= 0) {
+        std::cerr << "Invalid vector size: " << argv[1] << std::endl;
+        return 1;
+    }
+
     sycl::default_selector device_selector;
     sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
 
@@ -116,31 +259,25 @@ int main(int argc, char **argv)
     
     std::vector<TimingEvent> Events;
 
-    // single_queue_add<1024>(Q, Events);
-    // single_queue_add<2048>(Q, Events);
-    // single_queue_add<4096>(Q, Events);
-    // single_queue_add<8192>(Q, Events);
-    // single_queue_add<16384>(Q, Events);
-    // single_queue_add<32768>(Q, Events);
-    // single_queue_add<65536>(Q, Events);
-    // single_queue_add<131072>(Q, Events);
-    // single_queue_add<262144>(Q, Events);
-    // single_queue_add<524288>(Q, Events);
-    // single_queue_add<1048576>(Q, Events);
-    // single_queue_add<2097152>(Q, Events);
-    // single_queue_add<4194304>(Q, Events);
-    // single_queue_add<8388608>(Q, Events);
-    // single_queue_add<16777216>(Q, Events);
-    // single_queue_add<33554432>(Q, Events);
-    // single_queue_add<67108864>(Q, Events);
-    // single_queue_add<134217728>(Q, Events);
-    // single_queue_add<268435456>(Q, Events);
-    single_queue_add<536870912>(Q, Events);
-
-    for (const TimingEvent &event : Events)
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(VecSize) + ring_queues_footprint<int>(1, VecSize) + verify_footprint());
+
+    bool IsCorrect;
+    try
     {
-        std::cout << event.Name << "," << event.ExecTime << "," << event.VectorSize << "," << DevName << "\n";
+        IsCorrect = single_queue_add(Q, Arena, VecSize, Events);
     }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
 
-    return 0;
-}
\ No newline at end of file
+    // Rows follow TimingReport::csv_header(), the run scripts write the header once
+    TimingReport Report(DevName);
+    Report.add("gsq", Events);
+    Report.write_csv(std::cout, false);
+
+    return IsCorrect ? 0 : 1;
+}
+#endif
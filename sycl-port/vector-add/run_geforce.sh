@@ -12,22 +12,16 @@ output_file="timings_geforce.csv"
 
 cd $DIR
 module load cuda/11.5 llvm-clang
-# clang++ -Wall -fsycl -fsycl-targets=nvptx64-nvidia-cuda $FILE
+# clang++ -Wall -fsycl -fsycl-targets=nvptx64-nvidia-cuda va_bench.cpp -o $FILE
 pwd
 
+# FILE is the va_bench binary: one process sweeps every variant and size,
+# runs each configuration ITERS times and writes one aggregated row for it
 if [ ! -s "${output_file}" ]; then
-    echo "Event,ExecTime(ms),VectorSize,WorkGroupSize" >> $output_file
+    echo "Variant,Event,VectorSize,WorkGroupSize,Device,Samples,Min(ms),Median(ms),Mean(ms),P95(ms),P99(ms),StdDev(ms),Elements/s,GB/s" >> $output_file
 fi
 
-for ((i = 10; i < 30; i++))
-do
-    vector_size=$((2**$i))
-    ./${FILE} $vector_size
-    for ((j=0; j < ${ITERS}; j++))
-    do
-        ./${FILE} $vector_size >> $output_file
-    done
-done
+./${FILE} --min-size $((2**10)) --max-size $((2**29)) --warmup 1 --reps ${ITERS} | tail -n +2 >> $output_file
 echo "Completed run on GeForce for ${ITERS} iterations for ${FILE}"
 current_date_time="`date "+%Y-%m-%d %H:%M:%S"`";
 echo $current_date_time;
\ No newline at end of file
@@ -1,45 +1,40 @@
 #include <CL/sycl.hpp>
 #include "../../sycl_utils.hpp"
-#include "../../tasking/ArrayQueue.cpp"
+#include "../../device_arena.hpp"
+#include "../../tasking/DeviceBarrier.hpp"
+#include "../../tasking/RingQueue.hpp"
+#include "../../tasking/Scheduler.hpp"
 #include "../va_profiler.cpp"
+#include "../va_tracer.cpp"
+#include "../va_verify.cpp"
+#include "../va_autotune.cpp"
 
-template<std::size_t WorkGroupSize>
-void sk_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
+bool sk_multi_queue_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
 {
     const size_t NumWorkGroups = VecSize / WorkGroupSize;
     if (NumWorkGroups % 2 != 0 && NumWorkGroups != 1)
     {
         std::cerr << "Number of work groups should divide Vector Size evenly!" << "\n";
-        return;
+        return false;
     }
 
     auto StartTimePoint = std::chrono::high_resolution_clock::now();
 
-    auto TaskQueues = sycl::malloc_device<SPMCArrayQueue<int, WorkGroupSize>>(NumWorkGroups, Q);
-    // for (size_t i = 0; i < NumWorkGroups; i++)
-    // {
-    //     new (TaskQueues + i) SPMCArrayQueue<int, WorkGroupSize>();
-    // }
+    // Queues are constructed in parallel, one work-item per queue
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumWorkGroups, WorkGroupSize);
+    auto TaskQueues = QueueSet.Queues;
 
-    int *A = sycl::malloc_device<int>(VecSize, Q);
-    int *B = sycl::malloc_device<int>(VecSize, Q);
-    int *R = sycl::malloc_device<int>(VecSize, Q);
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
 
-    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
         A[idx] = 1;
         B[idx] = 0;
         R[idx] = 0;
     });
     Q.wait();
-    Q.single_task([=]()
-        {
-            for (size_t i = 0; i < NumWorkGroups; i++)
-            {
-                new (TaskQueues + i) SPMCArrayQueue<int, WorkGroupSize>();
-            }
-        }
-    );
-    Q.wait();
 
     auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
 
@@ -51,28 +46,112 @@ void sk_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
             auto &TargetQueue = TaskQueues[QueueIdx];
             sycl::group Group = Item.get_group();
 
-            if (Item.get_local_id() == 0)
-            {
-                for (int i = 0; i < WorkGroupSize; i++)
-                {
-                    int ItemVal = i + QueueIdx * WorkGroupSize;
-                    TargetQueue.push(ItemVal);
-                }
-            }
-
-            sycl::group_barrier(Group);
+            // group_push/group_pop synchronise the group themselves
+            TargetQueue.group_push(Group, static_cast<int>(Item.get_global_id()));
 
             int ItemVal = TargetQueue.front(Item.get_local_id());
             R[ItemVal] = A[ItemVal] + B[ItemVal];
 
-            sycl::group_barrier(Group);
+            TargetQueue.group_pop(Group, WorkGroupSize);
+        });
+    });
+    Q.wait();
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now(); 
+
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
+
+    auto StartKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Kernel Exec Time", VecSize, KernelProfileTime, WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Add Kernel", AddEvent);
+    }
 
-            if (Item.get_local_id() == 0)
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "sk", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+/*
+    Single-kernel GMQ with the queue head staged in local memory
+    - Once per scheduling round the group copies up to WorkGroupSize task ids
+      and the queue metadata into local memory (group_stage), so workers do
+      not index the global queue through m_size/m_nextElement themselves
+    - Completions are counted with a local atomic and popped by the leader in
+      one update per round (group_retire)
+*/
+bool sk_staged_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
+{
+    const size_t NumWorkGroups = VecSize / WorkGroupSize;
+    if (NumWorkGroups % 2 != 0 && NumWorkGroups != 1)
+    {
+        std::cerr << "Number of work groups should divide Vector Size evenly!" << "\n";
+        return false;
+    }
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    // Queues are constructed in parallel, one work-item per queue
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumWorkGroups, WorkGroupSize);
+    auto TaskQueues = QueueSet.Queues;
+
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    Q.wait();
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    sycl::event AddEvent = Q.submit([&](sycl::handler &h)
+    {
+        sycl::local_accessor<int, 1> Staged(sycl::range<1>{WorkGroupSize}, h);
+        sycl::local_accessor<int, 1> Meta(sycl::range<1>{3}, h);
+
+        h.parallel_for(sycl::nd_range<1>{sycl::range<1>{VecSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
+        {
+            int QueueIdx = Item.get_global_id() / WorkGroupSize;
+            auto &TargetQueue = TaskQueues[QueueIdx];
+            sycl::group Group = Item.get_group();
+            int ID = Item.get_local_id(0);
+
+            TargetQueue.group_push(Group, static_cast<int>(Item.get_global_id()));
+
+            while (true)
             {
-                while (!TargetQueue.empty())
+                int Count = TargetQueue.group_stage(Group, Staged, Meta, WorkGroupSize);
+                if (Count == 0)
+                {
+                    break;
+                }
+
+                if (ID < Count)
                 {
-                    TargetQueue.pop();
+                    int ItemVal = Staged[ID];
+                    R[ItemVal] = A[ItemVal] + B[ItemVal];
+                    TargetQueue.complete(Meta);
                 }
+
+                TargetQueue.group_retire(Group, Meta);
             }
         });
     });
@@ -80,14 +159,76 @@ void sk_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
 
     auto EndTimePoint = std::chrono::high_resolution_clock::now(); 
 
-    // int hostR[VecSize];
-    // Q.memcpy(hostR, R, VecSize * sizeof(int));
-    // Q.wait();
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
 
-    // std::cout << "Checking correctness:" << "\n";
-    // bool CorrectAdd = check_vector_add(hostR, VecSize);
-    // std::cout << "Vector Addition for size: " << VecSize << "\n";
-    // std::cout << "Correct? " << std::boolalpha << CorrectAdd << std::endl;
+    auto StartKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
+
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Kernel Exec Time", VecSize, KernelProfileTime, WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Staged Add Kernel", AddEvent);
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "sk-ls", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+struct VectorAddTask
+{
+    int *A;
+    int *B;
+    int *R;
+
+    void execute(int TaskId) const
+    {
+        R[TaskId] = A[TaskId] + B[TaskId];
+    }
+};
+
+/*
+    Single-kernel GMQ in sub-group mode: batches claimed with one atomic per
+    sub-group and executed in place, no work-group barriers at all
+*/
+bool sk_subgroup_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
+{
+    sycl::nd_range<1> Range = persistent_range(Q.get_device(), WorkGroupSize, (VecSize + WorkGroupSize - 1) / WorkGroupSize);
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    int *NextBatch = Arena.allocate<int>(1);
+
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    sycl::event FillEvent = Q.fill(NextBatch, 0, 1);
+    Q.wait();
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    SubGroupData Data{static_cast<int>(VecSize), NextBatch};
+    sycl::event AddEvent = subgroup_execute(Q, Data, Range, VectorAddTask{A, B, R});
+    Q.wait();
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now(); 
 
     durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
     durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
@@ -96,25 +237,36 @@ void sk_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
     auto EndKernelExecTimePoint = AddEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
     double KernelProfileTime = to_mili(EndKernelExecTimePoint - StartKernelExecTimePoint);
 
-    std::cout << "Total Exec Time" << "," << ExecTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Memory Setup Time" << "," << MemTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Kernel Exec Time" << "," << KernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Kernel Exec Time", VecSize, KernelProfileTime, WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("NextBatch Fill", FillEvent);
+        Tracer->device("Sub-group Add Kernel", AddEvent);
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "sk-sg", Events, Tracer);
 
-    // bool CorrectAdd = check_vector_add(R, VecSize);
-    // std::cout << "Vector Addition for size: " << VecSize << "\n";
-    // std::cout << "Correct? " << std::boolalpha << CorrectAdd << std::endl;
+    Arena.reset();
+    return IsCorrect;
+}
 
-    sycl::free(TaskQueues, Q);
-    sycl::free(A, Q);
-    sycl::free(B, Q);
-    sycl::free(R, Q);
+std::size_t sk_subgroup_footprint(const std::size_t VecSize)
+{
+    return 3 * DeviceArena::footprint<int>(VecSize) + DeviceArena::footprint<int>(1);
 }
 
+#ifndef VA_BENCH_DRIVER
 int main(int argc, char **argv)
 {
-    if (argc != 2)
+    if (argc < 2 || argc > 4)
     {
-        std::cerr << "Usage: " << argv[0] << " <Vector Size>" << "\n";
+        std::cerr << "Usage: " << argv[0] << " <Vector Size> [Work Group Size|auto] [wg|sg|ls]" << "\n";
         return 1;
     }
 
@@ -132,7 +284,23 @@ int main(int argc, char **argv)
 
     auto DevName = Device.get_info<sycl::info::device::name>();
 
-    constexpr std::size_t WorkGroupSize = 32;
+    std::size_t WorkGroupSize = 32;
+    if (argc >= 3)
+    {
+        WorkGroupSize = std::atoi(argv[2]);
+    }
+    // Tuned below, the smallest candidate sizes the arena for every other one
+    bool AutoTune = argc >= 3 && std::string(argv[2]) == "auto";
+    if (AutoTune)
+    {
+        WorkGroupSize = 32;
+    }
+    std::string Mode = argc == 4 ? argv[3] : "wg";
+    if (Mode != "wg" && Mode != "sg" && Mode != "ls")
+    {
+        std::cerr << "Unknown mode " << Mode << ", expected wg, sg or ls" << "\n";
+        return 1;
+    }
 
     auto MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
     if (WorkGroupSize > MaxGroupSize)
@@ -140,9 +308,65 @@ int main(int argc, char **argv)
         std::cerr << "Work Group Size cannot exceed " << MaxGroupSize << " on this device!" << "\n";
         return 1;
     }
+    if (!AutoTune && !valid_work_group_size(VecSize, WorkGroupSize, MaxGroupSize))
+    {
+        std::cerr << "Work Group Size must divide Vector Size into one or an even number of work groups" << "\n";
+        return 1;
+    }
 
-    
-    sk_multi_queue_add<WorkGroupSize>(Q, VecSize);
+    std::size_t NumWorkGroups = VecSize / WorkGroupSize;
+    DeviceArena Arena(Q, std::max(3 * DeviceArena::footprint<int>(VecSize) + ring_queues_footprint<int>(NumWorkGroups, WorkGroupSize),
+                                  sk_subgroup_footprint(VecSize)) + verify_footprint());
 
-    return 0;
-}
\ No newline at end of file
+    // Variant name of the mode, keys the tuning cache as in va_bench
+    std::string Variant = Mode == "wg" ? "sk" : "sk-" + Mode;
+    auto run_mode = [&](std::size_t Size, std::vector<TimingEvent> &RunEvents)
+    {
+        if (Mode == "sg")
+        {
+            return sk_subgroup_add(Q, Arena, VecSize, Size, RunEvents);
+        }
+        if (Mode == "ls")
+        {
+            return sk_staged_add(Q, Arena, VecSize, Size, RunEvents);
+        }
+        return sk_multi_queue_add(Q, Arena, VecSize, Size, RunEvents);
+    };
+
+    std::vector<TimingEvent> Events;
+    bool IsCorrect;
+    try
+    {
+        if (AutoTune)
+        {
+            WorkGroupTuner Tuner(Device);
+            WorkGroupSize = Tuner.tune(Variant, VecSize, candidate_work_group_sizes(Device), [&](std::size_t Candidate)
+            {
+                std::vector<TimingEvent> TuneEvents;
+                run_mode(Candidate, TuneEvents);
+                return total_exec_time(TuneEvents);
+            });
+            if (WorkGroupSize == 0)
+            {
+                std::cerr << "No valid Work Group Size for Vector Size " << VecSize << "\n";
+                return 1;
+            }
+        }
+
+        IsCorrect = run_mode(WorkGroupSize, Events);
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    // Rows follow TimingReport::csv_header(), the run scripts write the header once
+    TimingReport Report(DevName);
+    Report.add(Variant, Events);
+    Report.write_csv(std::cout, false);
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
+
+    return IsCorrect ? 0 : 1;
+}
+#endif
@@ -1,25 +1,27 @@
 #include <CL/sycl.hpp>
 #include "../../sycl_utils.hpp"
-#include "../../tasking/ArrayQueue.cpp"
+#include "../../device_arena.hpp"
+#include "../../tasking/RingQueue.hpp"
 #include "../va_profiler.cpp"
+#include "../va_tracer.cpp"
+#include "../va_verify.cpp"
+#include "../va_autotune.cpp"
 
-template<std::size_t WorkGroupSize>
-void split_kernel_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
+bool split_kernel_multi_queue_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, std::vector<TimingEvent> &Events,
+    EventTracer *Tracer = nullptr)
 {
     const size_t NumWorkGroups = VecSize / WorkGroupSize;
     if (NumWorkGroups % 2 != 0 && NumWorkGroups != 1)
     {
         std::cerr << "Number of work groups should divide Vector Size evenly!" << "\n";
-        return;
+        return false;
     }
 
     auto StartTimePoint = std::chrono::high_resolution_clock::now();
 
-    auto TaskQueues = sycl::malloc_device<SPMCArrayQueue<int, WorkGroupSize>>(NumWorkGroups, Q);
-    // for (size_t i = 0; i < NumWorkGroups; i++)
-    // {
-    //     new (TaskQueues + i) SPMCArrayQueue<int, WorkGroupSize>();
-    // }
+    // Queues are constructed in parallel, one work-item per queue
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumWorkGroups, WorkGroupSize);
+    auto TaskQueues = QueueSet.Queues;
 
     // int *A = sycl::malloc_shared<int>(VecSize, Q);
     // int *B = sycl::malloc_shared<int>(VecSize, Q);
@@ -30,25 +32,16 @@ void split_kernel_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
     //     A[i] = 1;
     //     B[i] = 0;
     // }
-    int *A = sycl::malloc_device<int>(VecSize, Q);
-    int *B = sycl::malloc_device<int>(VecSize, Q);
-    int *R = sycl::malloc_device<int>(VecSize, Q);
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
 
-    Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
         A[idx] = 1;
         B[idx] = 0;
         R[idx] = 0;
     });
     Q.wait();
-    Q.single_task([=]()
-        {
-            for (size_t i = 0; i < NumWorkGroups; i++)
-            {
-                new (TaskQueues + i) SPMCArrayQueue<int, WorkGroupSize>();
-            }
-        }
-    );
-    Q.wait();
 
     auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
 
@@ -56,17 +49,11 @@ void split_kernel_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
     {
         h.parallel_for(sycl::nd_range<1>{sycl::range<1>{VecSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
         {
-            if (Item.get_local_id() == 0)
-            {
-                int QueueIdx = Item.get_global_id() / WorkGroupSize;
-                auto &TargetQueue = TaskQueues[QueueIdx];
-
-                for (int i = 0; i < WorkGroupSize; i++)
-                {
-                    int ItemVal = i + QueueIdx * WorkGroupSize;
-                    TargetQueue.push(ItemVal);
-                }
-            }
+            int QueueIdx = Item.get_global_id() / WorkGroupSize;
+            auto &TargetQueue = TaskQueues[QueueIdx];
+
+            int ItemVal = Item.get_global_id();
+            TargetQueue.group_push(Item.get_group(), ItemVal);
         });
     });
     Q.wait();
@@ -88,16 +75,10 @@ void split_kernel_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
     {
         h.parallel_for(sycl::nd_range<1>{sycl::range<1>{VecSize}, sycl::range<1>{WorkGroupSize}}, [=](sycl::nd_item<1> Item)
         {
-            if (Item.get_local_id() == 0)
-            {
-                int QueueIdx = Item.get_global_id() / WorkGroupSize;
-                auto &TargetQueue = TaskQueues[QueueIdx];
+            int QueueIdx = Item.get_global_id() / WorkGroupSize;
+            auto &TargetQueue = TaskQueues[QueueIdx];
 
-                while (!TargetQueue.empty())
-                {
-                    TargetQueue.pop();
-                }
-            }
+            TargetQueue.group_pop(Item.get_group(), TargetQueue.size());
         });
     });
     Q.wait();
@@ -119,23 +100,161 @@ void split_kernel_multi_queue_add(sycl::queue &Q, const std::size_t VecSize)
     auto EndShutdownKernelExecTimePoint = ShutdownEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
     double ShutdownKernelProfileTime = to_mili(EndShutdownKernelExecTimePoint - StartShutdownKernelExecTimePoint);
 
-    std::cout << "Total Exec Time" << "," << ExecTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Memory Setup Time" << "," << MemTime.count() << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Enqueue Exec Time" << "," << EnqueueKernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Add Kernel Exec Time" << "," << AddKernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
-    std::cout << "Shutdown Kernel Exec Time" << "," << ShutdownKernelProfileTime << "," << VecSize << "," << WorkGroupSize << "\n";
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Enqueue Exec Time", VecSize, EnqueueKernelProfileTime, WorkGroupSize});
+    Events.push_back({"Add Kernel Exec Time", VecSize, AddKernelProfileTime, WorkGroupSize});
+    Events.push_back({"Shutdown Kernel Exec Time", VecSize, ShutdownKernelProfileTime, WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host("Tasking", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        Tracer->device("Enqueue Kernel", EnqueueEvent);
+        Tracer->device("Add Kernel", AddEvent);
+        Tracer->device("Shutdown Kernel", ShutdownEvent);
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "split", Events, Tracer);
 
-    sycl::free(TaskQueues, Q);
-    sycl::free(A, Q);
-    sycl::free(B, Q);
-    sycl::free(R, Q);
+    Arena.reset();
+    return IsCorrect;
 }
 
+/*
+    Stream of batches over the split-kernel queues
+    - VecSize elements are processed in batches of BatchSize, every batch runs the
+      enqueue -> add -> shutdown kernels on one of two queue sets in turn
+    - Pipelined chains the kernels with depends_on only and waits once at the end,
+      so batch k+1 is enqueued while batch k is still executing
+    - Otherwise every kernel is followed by Q.wait(), as in split_kernel_multi_queue_add
+    - Batch Stream Time starts before the A/B/R init kernel in both modes,
+      pipelined runs overlap it with the first batches
+*/
+bool split_kernel_batched_add(sycl::queue &Q, DeviceArena &Arena, const std::size_t VecSize, const std::size_t WorkGroupSize, const std::size_t BatchSize,
+    bool Pipelined, std::vector<TimingEvent> &Events, EventTracer *Tracer = nullptr)
+{
+    if (BatchSize % WorkGroupSize != 0 || VecSize % WorkGroupSize != 0)
+    {
+        std::cerr << "Work Group Size should divide Batch Size and Vector Size evenly!" << "\n";
+        return false;
+    }
+
+    const std::size_t NumBatches = (VecSize + BatchSize - 1) / BatchSize;
+    const std::size_t NumSets = std::min<std::size_t>(2, NumBatches);
+    const std::size_t GroupsPerBatch = BatchSize / WorkGroupSize;
+
+    auto StartTimePoint = std::chrono::high_resolution_clock::now();
+
+    auto QueueSet = make_ring_queues<int>(Q, Arena, NumSets * GroupsPerBatch, WorkGroupSize);
+
+    int *A = Arena.allocate<int>(VecSize);
+    int *B = Arena.allocate<int>(VecSize);
+    int *R = Arena.allocate<int>(VecSize);
+
+    auto MemorySetupTimePoint = std::chrono::high_resolution_clock::now();
+
+    sycl::event InitEvent = Q.parallel_for(VecSize, [=](sycl::id<1> idx) {
+        A[idx] = 1;
+        B[idx] = 0;
+        R[idx] = 0;
+    });
+    if (!Pipelined) Q.wait();
+
+    // last shutdown per queue set, a set is only reused once its previous batch drained
+    std::vector<sycl::event> SetFree(NumSets);
+    std::vector<std::pair<std::string, sycl::event>> BatchCommands; // for the tracer
+
+    for (std::size_t Batch = 0; Batch < NumBatches; Batch++)
+    {
+        auto TaskQueues = QueueSet.Queues + (Batch % NumSets) * GroupsPerBatch;
+        const std::size_t Offset = Batch * BatchSize;
+        const std::size_t Size = std::min(BatchSize, VecSize - Offset);
+        sycl::nd_range<1> Range{sycl::range<1>{Size}, sycl::range<1>{WorkGroupSize}};
+
+        sycl::event EnqueueEvent = Q.submit([&](sycl::handler &h)
+        {
+            if (Batch >= NumSets)
+            {
+                h.depends_on(SetFree[Batch % NumSets]);
+            }
+            h.parallel_for(Range, [=](sycl::nd_item<1> Item)
+            {
+                auto &TargetQueue = TaskQueues[Item.get_group_linear_id()];
+
+                int ItemVal = Offset + Item.get_global_id(0);
+                TargetQueue.group_push(Item.get_group(), ItemVal);
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        sycl::event AddEvent = Q.submit([&](sycl::handler &h)
+        {
+            h.depends_on({InitEvent, EnqueueEvent});
+            h.parallel_for(Range, [=](sycl::nd_item<1> Item)
+            {
+                auto &TargetQueue = TaskQueues[Item.get_group_linear_id()];
+
+                int ItemVal = TargetQueue.front(Item.get_local_id(0));
+                R[ItemVal] = A[ItemVal] + B[ItemVal];
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        SetFree[Batch % NumSets] = Q.submit([&](sycl::handler &h)
+        {
+            h.depends_on(AddEvent);
+            h.parallel_for(Range, [=](sycl::nd_item<1> Item)
+            {
+                auto &TargetQueue = TaskQueues[Item.get_group_linear_id()];
+
+                TargetQueue.group_pop(Item.get_group(), TargetQueue.size());
+            });
+        });
+        if (!Pipelined) Q.wait();
+
+        BatchCommands.push_back({"Enqueue Kernel", EnqueueEvent});
+        BatchCommands.push_back({"Add Kernel", AddEvent});
+        BatchCommands.push_back({"Shutdown Kernel", SetFree[Batch % NumSets]});
+    }
+    Q.wait();
+
+    auto EndTimePoint = std::chrono::high_resolution_clock::now();
+
+    durationMiliSecs ExecTime = EndTimePoint - StartTimePoint;
+    durationMiliSecs MemTime = MemorySetupTimePoint - StartTimePoint;
+    durationMiliSecs StreamTime = EndTimePoint - MemorySetupTimePoint;
+
+    Events.push_back({"Total Exec Time", VecSize, ExecTime.count(), WorkGroupSize});
+    Events.push_back({"Memory Setup Time", VecSize, MemTime.count(), WorkGroupSize});
+    Events.push_back({"Batch Stream Time", VecSize, StreamTime.count(), WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->host("Memory Setup", StartTimePoint, MemorySetupTimePoint);
+        Tracer->host(Pipelined ? "Pipelined Batches" : "Batches", MemorySetupTimePoint, EndTimePoint);
+        Tracer->device("Queue Construction", QueueSet.InitEvent);
+        Tracer->device("Init Kernel", InitEvent);
+        for (const auto &Command : BatchCommands)
+        {
+            Tracer->device(Command.first, Command.second);
+        }
+    }
+
+    bool IsCorrect = verify_vector_add(Q, Arena, R, VecSize, WorkGroupSize, "split", Events, Tracer);
+
+    Arena.reset();
+    return IsCorrect;
+}
+
+#ifndef VA_BENCH_DRIVER
 int main(int argc, char **argv)
 {
-    if (argc != 2)
+    if (argc != 2 && argc != 3)
     {
-        std::cerr << "Usage: " << argv[0] << " <Vector Size>" << "\n";
+        std::cerr << "Usage: " << argv[0] << " <Vector Size> [Work Group Size|auto]" << "\n";
         return 1;
     }
 
@@ -153,26 +272,71 @@ int main(int argc, char **argv)
 
     auto DevName = Device.get_info<sycl::info::device::name>();
 
-    constexpr std::size_t WorkGroupSize = 1024;
+    std::size_t WorkGroupSize = 1024;
+    if (argc == 3)
+    {
+        WorkGroupSize = std::atoi(argv[2]);
+    }
+    // Tuned below, the smallest candidate sizes the arena for every other one
+    bool AutoTune = argc >= 3 && std::string(argv[2]) == "auto";
+    if (AutoTune)
+    {
+        WorkGroupSize = 32;
+    }
 
-    // auto MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
-    // if (WorkGroupSize > MaxGroupSize)
-    // {
-    //     std::cerr << "Work Group Size cannot exceed " << MaxGroupSize << " on this device!" << "\n";
-    //     return 1;
-    // }
+    auto MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+    if (WorkGroupSize > MaxGroupSize)
+    {
+        std::cerr << "Work Group Size cannot exceed " << MaxGroupSize << " on this device!" << "\n";
+        return 1;
+    }
+    if (!AutoTune && !valid_work_group_size(VecSize, WorkGroupSize, MaxGroupSize))
+    {
+        std::cerr << "Work Group Size must divide Vector Size into one or an even number of work groups" << "\n";
+        return 1;
+    }
 
     // ------------------------
     // PROFILING
     // ------------------------
     
-    split_kernel_multi_queue_add<WorkGroupSize>(Q, VecSize);
-    // split_kernel_multi_queue_add<32>(Q, VecSize);
-    // split_kernel_multi_queue_add<64>(Q, VecSize);
-    // split_kernel_multi_queue_add<128>(Q, VecSize);
-    // split_kernel_multi_queue_add<256>(Q, VecSize);
-    // split_kernel_multi_queue_add<512>(Q, VecSize);
-    // split_kernel_multi_queue_add<1024>(Q, VecSize);
-
-    return 0;
-}
\ No newline at end of file
+    std::size_t NumWorkGroups = VecSize / WorkGroupSize;
+    DeviceArena Arena(Q, 3 * DeviceArena::footprint<int>(VecSize) + ring_queues_footprint<int>(NumWorkGroups, WorkGroupSize) + verify_footprint());
+
+    std::vector<TimingEvent> Events;
+    bool IsCorrect;
+    try
+    {
+        if (AutoTune)
+        {
+            WorkGroupTuner Tuner(Device);
+            WorkGroupSize = Tuner.tune("split", VecSize, candidate_work_group_sizes(Device), [&](std::size_t Candidate)
+            {
+                std::vector<TimingEvent> TuneEvents;
+                split_kernel_multi_queue_add(Q, Arena, VecSize, Candidate, TuneEvents);
+                return total_exec_time(TuneEvents);
+            });
+            if (WorkGroupSize == 0)
+            {
+                std::cerr << "No valid Work Group Size for Vector Size " << VecSize << "\n";
+                return 1;
+            }
+        }
+
+        IsCorrect = split_kernel_multi_queue_add(Q, Arena, VecSize, WorkGroupSize, Events);
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    // Rows follow TimingReport::csv_header(), the run scripts write the header once
+    TimingReport Report(DevName);
+    Report.add("split", Events);
+    Report.write_csv(std::cout, false);
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
+
+    return IsCorrect ? 0 : 1;
+}
+#endif
@@ -11,7 +11,7 @@ def main(args):
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Run an sbatch script to time the execution of a specified vector addition code.")
     parser.add_argument(
-        "--iters", type=int, help="Number of times to run the code."
+        "--iters", type=int, help="Repetitions per configuration, passed to va_bench --reps."
         ,required=True
     )
     parser.add_argument(
@@ -19,7 +19,7 @@ if __name__ == "__main__":
         ,required=True
     )
     parser.add_argument(
-        "--file", type=str, help="C++ file to compile and run."
+        "--file", type=str, help="va_bench binary to run."
         ,required=True
     )
     parser.add_argument(
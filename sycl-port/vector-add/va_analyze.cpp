@@ -0,0 +1,524 @@
+/*
+    Command-line analyzer for vector-add timing CSVs (host only, no SYCL needed)
+    - Streams every file line by line and normalizes the schemas found in the tree:
+        Event,ExecTime(ms),VectorSize[,WorkGroupSize][,Device]   raw samples, some
+            files have fewer header columns than row columns
+        Variant,Event,VectorSize,WorkGroupSize,Device,Samples,... TimingReport rows
+    - Groups by variant, event, vector size, work-group size and device and
+      prints median, mean and 95% confidence interval of the mean, plus the
+      speedup of the median against the baseline variant (usm by default)
+    - With --compare, every group of the base set is tested against the same
+      group of the new set with Welch's t-test, slower means that are
+      significant and above the threshold are flagged and the exit code is 1
+
+    The variant of raw sample files comes from their directory (basic-add-usm,
+    gsq-add, ...) unless given as variant=path; their device, when the rows
+    have none, from the file name suffix (timings_a100.csv -> the A100 node).
+
+    Usage: va_analyze [--baseline usm] [--event "Total Exec Time"] [--alpha 0.05]
+                      [--threshold 0.05] <files...> [--compare <files...>]
+*/
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct GroupKey
+{
+    std::string Variant;
+    std::string Event;
+    std::size_t VectorSize;
+    std::size_t WorkGroupSize;
+    std::string Device;
+
+    bool operator<(const GroupKey &Other) const
+    {
+        return std::tie(Variant, Event, VectorSize, WorkGroupSize, Device)
+             < std::tie(Other.Variant, Other.Event, Other.VectorSize, Other.WorkGroupSize, Other.Device);
+    }
+};
+
+/*
+    Raw samples are kept for the median, summary rows only contribute their
+    median (weighted by their sample count) and their moments
+*/
+class GroupStats
+{
+    public:
+        void add_sample(double Value)
+        {
+            m_samples.push_back(Value);
+            merge(1, Value, 0.0);
+        }
+
+        void add_summary(std::size_t Samples, double Median, double Mean, double StdDev)
+        {
+            if (Samples == 0)
+            {
+                return;
+            }
+            m_summaryMedians.push_back({Median, Samples});
+            merge(Samples, Mean, StdDev * StdDev * (Samples - 1));
+        }
+
+        std::size_t count() const { return m_count; }
+        double mean() const { return m_mean; }
+        double variance() const { return m_count > 1 ? m_m2 / (m_count - 1) : 0.0; }
+
+        double median() const
+        {
+            std::vector<std::pair<double, std::size_t>> Weighted = m_summaryMedians;
+            for (double Value : m_samples)
+            {
+                Weighted.push_back({Value, 1});
+            }
+            if (Weighted.empty())
+            {
+                return 0.0;
+            }
+            std::sort(Weighted.begin(), Weighted.end());
+
+            std::size_t Total = 0;
+            for (const auto &Item : Weighted) Total += Item.second;
+
+            // average of the two middle ranks, as for an even sample count
+            std::size_t Low = (Total - 1) / 2;
+            std::size_t High = Total / 2;
+            double LowValue = 0.0;
+            double HighValue = 0.0;
+            std::size_t Seen = 0;
+            for (const auto &Item : Weighted)
+            {
+                if (Low >= Seen && Low < Seen + Item.second) LowValue = Item.first;
+                if (High >= Seen && High < Seen + Item.second) HighValue = Item.first;
+                Seen += Item.second;
+            }
+            return (LowValue + HighValue) / 2;
+        }
+
+    private:
+        // Chan et al. pairwise update of count, mean and sum of squared deviations
+        void merge(std::size_t Count, double Mean, double M2)
+        {
+            std::size_t Total = m_count + Count;
+            double Delta = Mean - m_mean;
+            m_mean += Delta * Count / Total;
+            m_m2 += M2 + Delta * Delta * static_cast<double>(m_count) * Count / Total;
+            m_count = Total;
+        }
+
+        std::vector<double> m_samples;
+        std::vector<std::pair<double, std::size_t>> m_summaryMedians;
+        std::size_t m_count = 0;
+        double m_mean = 0.0;
+        double m_m2 = 0.0;
+};
+
+using ResultSet = std::map<GroupKey, GroupStats>;
+
+// ------------------------
+// Student t distribution
+// ------------------------
+
+/*
+    Continued fraction of the regularized incomplete beta function
+*/
+double beta_continued_fraction(double a, double b, double x)
+{
+    const double Tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    d = 1.0 / (std::fabs(d) < Tiny ? Tiny : d);
+    double h = d;
+    for (int m = 1; m <= 300; m++)
+    {
+        for (int Step = 0; Step < 2; Step++)
+        {
+            double Num = Step == 0 ? m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m))
+                                   : -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+            d = 1.0 + Num * d;
+            d = 1.0 / (std::fabs(d) < Tiny ? Tiny : d);
+            c = 1.0 + Num / c;
+            if (std::fabs(c) < Tiny) c = Tiny;
+            h *= d * c;
+            if (Step == 1 && std::fabs(d * c - 1.0) < 1e-12)
+            {
+                return h;
+            }
+        }
+    }
+    return h;
+}
+
+double incomplete_beta(double a, double b, double x)
+{
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double Front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0))
+    {
+        return Front * beta_continued_fraction(a, b, x) / a;
+    }
+    return 1.0 - Front * beta_continued_fraction(b, a, 1.0 - x) / b;
+}
+
+/*
+    P(|T| >= t) for T ~ Student t with Df degrees of freedom
+*/
+double t_two_sided_p(double t, double Df)
+{
+    return incomplete_beta(Df / 2.0, 0.5, Df / (Df + t * t));
+}
+
+/*
+    t with P(|T| >= t) = Alpha, by bisection
+*/
+double t_critical(double Alpha, double Df)
+{
+    double Low = 0.0;
+    double High = 1000.0;
+    for (int i = 0; i < 100; i++)
+    {
+        double Mid = (Low + High) / 2;
+        if (t_two_sided_p(Mid, Df) > Alpha) Low = Mid;
+        else High = Mid;
+    }
+    return (Low + High) / 2;
+}
+
+// ------------------------
+// CSV input
+// ------------------------
+
+/*
+    Comma separated fields, a field in double quotes may hold commas and
+    doubled quotes, as TimingReport writes device names
+*/
+std::vector<std::string> split_fields(const std::string &Line)
+{
+    std::vector<std::string> Fields;
+    std::string Field;
+    bool Quoted = false;
+    for (std::size_t i = 0; i < Line.size(); i++)
+    {
+        char c = Line[i];
+        if (Quoted && c == '"' && i + 1 < Line.size() && Line[i + 1] == '"')
+        {
+            Field += '"';
+            i++;
+        }
+        else if (c == '"')
+        {
+            Quoted = !Quoted;
+        }
+        else if (c == ',' && !Quoted)
+        {
+            Fields.push_back(Field);
+            Field.clear();
+        }
+        else
+        {
+            Field += c;
+        }
+    }
+    if (!Line.empty())
+    {
+        Fields.push_back(Field);
+    }
+    return Fields;
+}
+
+/*
+    Inverse of split_fields for one field
+*/
+std::string csv_field(const std::string &Text)
+{
+    if (Text.find_first_of(",\"\n") == std::string::npos)
+    {
+        return Text;
+    }
+    std::string Quoted = "\"";
+    for (char c : Text)
+    {
+        if (c == '"') Quoted += '"';
+        Quoted += c;
+    }
+    return Quoted + "\"";
+}
+
+bool parse_number(const std::string &Text, double &Value)
+{
+    try
+    {
+        std::size_t Used = 0;
+        Value = std::stod(Text, &Used);
+        return Used == Text.size() || Text.find_first_not_of(" \r", Used) == std::string::npos;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+std::string variant_from_path(const std::string &Path)
+{
+    static const std::vector<std::pair<std::string, std::string>> Directories{
+        {"basic-add-usm", "usm"},
+        {"gsq-add", "gsq"},
+        {"single-kernel-multiQ-add", "sk"},
+        {"split-kernel-multiQ-add", "split"},
+        {"device-barrier-add", "db"},
+    };
+    for (const auto &Directory : Directories)
+    {
+        if (Path.find(Directory.first) != std::string::npos)
+        {
+            return Directory.second;
+        }
+    }
+    return "unknown";
+}
+
+/*
+    Suffixes of the run scripts (run_a100.sh, run_geforce.sh) map to the device
+    names those machines report, so the files group with the ones that have them
+*/
+std::string device_from_path(const std::string &Path)
+{
+    static const std::map<std::string, std::string> Machines{
+        {"a100", "NVIDIA A100 80GB PCIe"},
+        {"geforce", "NVIDIA GeForce RTX 2080 Ti"},
+    };
+
+    std::string Name = Path.substr(Path.find_last_of('/') + 1);
+    Name = Name.substr(0, Name.find_last_of('.'));
+    std::size_t Underscore = Name.find_last_of('_');
+    if (Underscore == std::string::npos)
+    {
+        return "unknown";
+    }
+
+    std::string Suffix = Name.substr(Underscore + 1);
+    auto Machine = Machines.find(Suffix);
+    return Machine == Machines.end() ? Suffix : Machine->second;
+}
+
+/*
+    Spec is "path" or "variant=path", returns false if the file cannot be read
+*/
+bool read_results(const std::string &Spec, ResultSet &Results)
+{
+    std::size_t Equals = Spec.find('=');
+    std::string Path = Equals == std::string::npos ? Spec : Spec.substr(Equals + 1);
+    std::string FileVariant = Equals == std::string::npos ? variant_from_path(Path) : Spec.substr(0, Equals);
+    std::string FileDevice = device_from_path(Path);
+
+    std::ifstream File(Path);
+    if (!File)
+    {
+        std::cerr << "Cannot open " << Path << "\n";
+        return false;
+    }
+
+    std::size_t Skipped = 0;
+    std::string Line;
+    while (std::getline(File, Line))
+    {
+        if (!Line.empty() && Line.back() == '\r') Line.pop_back();
+        std::vector<std::string> Fields = split_fields(Line);
+        if (Fields.empty() || Fields[0] == "Event" || Fields[0] == "Variant")
+        {
+            continue;
+        }
+
+        double Value;
+        double Size;
+
+        // TimingReport: Variant,Event,VectorSize,WorkGroupSize,Device,Samples,Min,Median,Mean,P95,P99,StdDev,...
+        if (Fields.size() >= 12 && parse_number(Fields[2], Size))
+        {
+            double WorkGroupSize, Samples, Median, Mean, StdDev;
+            if (parse_number(Fields[3], WorkGroupSize) && parse_number(Fields[5], Samples) && parse_number(Fields[7], Median)
+                && parse_number(Fields[8], Mean) && parse_number(Fields[11], StdDev))
+            {
+                GroupKey Key{Fields[0], Fields[1], static_cast<std::size_t>(Size), static_cast<std::size_t>(WorkGroupSize), Fields[4]};
+                Results[Key].add_summary(static_cast<std::size_t>(Samples), Median, Mean, StdDev);
+                continue;
+            }
+        }
+
+        // Raw sample: Event,ExecTime,VectorSize, then an optional work-group size and device in any order
+        if (Fields.size() >= 3 && parse_number(Fields[1], Value) && parse_number(Fields[2], Size))
+        {
+            GroupKey Key{FileVariant, Fields[0], static_cast<std::size_t>(Size), 0, FileDevice};
+            for (std::size_t i = 3; i < Fields.size(); i++)
+            {
+                double WorkGroupSize;
+                if (parse_number(Fields[i], WorkGroupSize)) Key.WorkGroupSize = static_cast<std::size_t>(WorkGroupSize);
+                else if (!Fields[i].empty()) Key.Device = Fields[i];
+            }
+            Results[Key].add_sample(Value);
+            continue;
+        }
+
+        Skipped++;
+    }
+
+    if (Skipped > 0)
+    {
+        std::cerr << Path << ": skipped " << Skipped << " unrecognised lines" << "\n";
+    }
+    return true;
+}
+
+// ------------------------
+// Reports
+// ------------------------
+
+void write_summary(std::ostream &os, const ResultSet &Results, const std::string &Baseline, const std::string &EventFilter)
+{
+    os << "Variant,Event,VectorSize,WorkGroupSize,Device,Samples,Median(ms),Mean(ms),CI95Low(ms),CI95High(ms),SpeedupVs" << Baseline << "\n";
+
+    for (const auto &Item : Results)
+    {
+        const GroupKey &Key = Item.first;
+        const GroupStats &Stats = Item.second;
+        if (!EventFilter.empty() && Key.Event != EventFilter)
+        {
+            continue;
+        }
+
+        double HalfWidth = 0.0;
+        if (Stats.count() > 1)
+        {
+            HalfWidth = t_critical(0.05, Stats.count() - 1) * std::sqrt(Stats.variance() / Stats.count());
+        }
+
+        os << csv_field(Key.Variant) << "," << csv_field(Key.Event) << "," << Key.VectorSize << "," << Key.WorkGroupSize << "," << csv_field(Key.Device) << ","
+           << Stats.count() << "," << Stats.median() << "," << Stats.mean() << ","
+           << Stats.mean() - HalfWidth << "," << Stats.mean() + HalfWidth << ",";
+
+        // the baseline has no work-group size, match it on everything else
+        auto BaselineStats = Results.find({Baseline, Key.Event, Key.VectorSize, 0, Key.Device});
+        if (BaselineStats != Results.end() && Stats.median() > 0)
+        {
+            os << BaselineStats->second.median() / Stats.median();
+        }
+        os << "\n";
+    }
+}
+
+/*
+    Returns the number of regressions
+*/
+int write_comparison(std::ostream &os, const ResultSet &Base, const ResultSet &New, const std::string &EventFilter, double Alpha, double Threshold)
+{
+    os << "Variant,Event,VectorSize,WorkGroupSize,Device,BaseSamples,NewSamples,BaseMean(ms),NewMean(ms),Change(%),PValue,Regression" << "\n";
+
+    int Regressions = 0;
+    for (const auto &Item : Base)
+    {
+        const GroupKey &Key = Item.first;
+        if (!EventFilter.empty() && Key.Event != EventFilter)
+        {
+            continue;
+        }
+        auto Match = New.find(Key);
+        if (Match == New.end())
+        {
+            continue;
+        }
+
+        const GroupStats &A = Item.second;
+        const GroupStats &B = Match->second;
+
+        // Welch's t-test, needs a spread estimate on both sides
+        double PValue = 1.0;
+        if (A.count() > 1 && B.count() > 1)
+        {
+            double VarA = A.variance() / A.count();
+            double VarB = B.variance() / B.count();
+            double Spread = VarA + VarB;
+            if (Spread > 0)
+            {
+                double t = (B.mean() - A.mean()) / std::sqrt(Spread);
+                double Df = Spread * Spread / (VarA * VarA / (A.count() - 1) + VarB * VarB / (B.count() - 1));
+                PValue = t_two_sided_p(t, Df);
+            }
+        }
+
+        double Change = A.mean() > 0 ? (B.mean() - A.mean()) / A.mean() : 0.0;
+        bool IsRegression = PValue < Alpha && Change > Threshold;
+        Regressions += IsRegression;
+
+        os << csv_field(Key.Variant) << "," << csv_field(Key.Event) << "," << Key.VectorSize << "," << Key.WorkGroupSize << "," << csv_field(Key.Device) << ","
+           << A.count() << "," << B.count() << "," << A.mean() << "," << B.mean() << ","
+           << Change * 100 << "," << PValue << "," << (IsRegression ? "yes" : "no") << "\n";
+    }
+    return Regressions;
+}
+
+int main(int argc, char **argv)
+{
+    std::string Baseline = "usm";
+    std::string EventFilter;
+    double Alpha = 0.05;
+    double Threshold = 0.05;
+    std::vector<std::string> BaseFiles;
+    std::vector<std::string> NewFiles;
+    bool Comparing = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string Arg = argv[i];
+        bool HasValue = i + 1 < argc;
+        if (Arg == "--baseline" && HasValue) Baseline = argv[++i];
+        else if (Arg == "--event" && HasValue) EventFilter = argv[++i];
+        else if (Arg == "--alpha" && HasValue) Alpha = std::stod(argv[++i]);
+        else if (Arg == "--threshold" && HasValue) Threshold = std::stod(argv[++i]);
+        else if (Arg == "--compare") Comparing = true;
+        else if (Arg.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option: " << Arg << "\n";
+            return 1;
+        }
+        else (Comparing ? NewFiles : BaseFiles).push_back(Arg);
+    }
+    if (BaseFiles.empty() || (Comparing && NewFiles.empty()))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--baseline usm] [--event \"Total Exec Time\"] [--alpha 0.05] [--threshold 0.05]"
+                  << " <files...> [--compare <files...>]" << "\n";
+        return 1;
+    }
+
+    ResultSet Base;
+    for (const std::string &File : BaseFiles)
+    {
+        if (!read_results(File, Base)) return 1;
+    }
+
+    if (!Comparing)
+    {
+        write_summary(std::cout, Base, Baseline, EventFilter);
+        return 0;
+    }
+
+    ResultSet New;
+    for (const std::string &File : NewFiles)
+    {
+        if (!read_results(File, New)) return 1;
+    }
+
+    int Regressions = write_comparison(std::cout, Base, New, EventFilter, Alpha, Threshold);
+    if (Regressions > 0)
+    {
+        std::cerr << Regressions << " significant regressions" << "\n";
+        return 1;
+    }
+    return 0;
+}
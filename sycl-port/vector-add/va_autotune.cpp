@@ -0,0 +1,192 @@
+#ifndef _VA_AUTOTUNE_CPP_
+#define _VA_AUTOTUNE_CPP_
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <CL/sycl.hpp>
+#include "va_profiler.cpp"
+
+/*
+    Same constraint the GMQ variants check before launching
+*/
+bool valid_work_group_size(std::size_t VecSize, std::size_t WorkGroupSize, std::size_t MaxGroupSize)
+{
+    if (WorkGroupSize == 0 || WorkGroupSize > MaxGroupSize || WorkGroupSize > VecSize || VecSize % WorkGroupSize != 0)
+    {
+        return false;
+    }
+    std::size_t NumWorkGroups = VecSize / WorkGroupSize;
+    return NumWorkGroups % 2 == 0 || NumWorkGroups == 1;
+}
+
+/*
+    Powers of two from 32 up to the device limit, the sizes the tuner tries
+*/
+std::vector<std::size_t> candidate_work_group_sizes(const sycl::device &Device)
+{
+    std::size_t MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+    std::vector<std::size_t> Sizes;
+    for (std::size_t Size = 32; Size <= MaxGroupSize; Size *= 2)
+    {
+        Sizes.push_back(Size);
+    }
+    return Sizes;
+}
+
+/*
+    Work-group size autotuner
+    - On the first request for a (kernel, problem size) pair every valid
+      candidate is run and timed, the fastest median wins
+    - Winners are kept in a tab separated cache file, one line per
+      device name, driver version, kernel and problem size, so a new driver
+      or another device is tuned again
+    - The cache is read when the tuner is built and rewritten after every
+      new winner; entries of other devices in the file are kept
+*/
+class WorkGroupTuner
+{
+    public:
+        WorkGroupTuner(const sycl::device &Device, const std::string &CachePath = "wg_tuning.cache", int Reps = 3)
+            : m_device(Device.get_info<sycl::info::device::name>()),
+              m_driver(Device.get_info<sycl::info::device::driver_version>()),
+              m_maxGroupSize(Device.get_info<sycl::info::device::max_work_group_size>()),
+              m_cachePath(CachePath), m_reps(std::max(Reps, 1))
+        {
+            load();
+        };
+
+        /*
+            Run(WorkGroupSize) executes the kernel once and returns its time in ms
+            Returns 0 if no candidate is valid for ProblemSize
+        */
+        std::size_t tune(const std::string &Kernel, std::size_t ProblemSize, const std::vector<std::size_t> &Candidates,
+            const std::function<double(std::size_t)> &Run)
+        {
+            std::string Key = key(Kernel, ProblemSize);
+            auto Cached = m_entries.find(Key);
+            if (Cached != m_entries.end())
+            {
+                return Cached->second.WorkGroupSize;
+            }
+
+            Entry Best{0, 0.0};
+            for (std::size_t WorkGroupSize : Candidates)
+            {
+                if (!valid_work_group_size(ProblemSize, WorkGroupSize, m_maxGroupSize))
+                {
+                    continue;
+                }
+
+                // first run pays the JIT and is not counted
+                Run(WorkGroupSize);
+                std::vector<double> Times;
+                for (int Rep = 0; Rep < m_reps; Rep++)
+                {
+                    Times.push_back(Run(WorkGroupSize));
+                }
+                double Median = median(Times);
+
+                if (Median == std::numeric_limits<double>::infinity())
+                {
+                    continue;
+                }
+                if (Best.WorkGroupSize == 0 || Median < Best.Time)
+                {
+                    Best = {WorkGroupSize, Median};
+                }
+            }
+
+            if (Best.WorkGroupSize != 0)
+            {
+                m_entries[Key] = Best;
+                save();
+            }
+            return Best.WorkGroupSize;
+        }
+
+    private:
+        struct Entry
+        {
+            std::size_t WorkGroupSize;
+            double Time; // median ms of the winner
+        };
+
+        std::string key(const std::string &Kernel, std::size_t ProblemSize) const
+        {
+            return key(m_device, m_driver, Kernel, std::to_string(ProblemSize));
+        }
+
+        static std::string key(const std::string &Device, const std::string &Driver, const std::string &Kernel, const std::string &ProblemSize)
+        {
+            return Device + "\t" + Driver + "\t" + Kernel + "\t" + ProblemSize;
+        }
+
+        void load()
+        {
+            std::ifstream File(m_cachePath);
+            std::string Line;
+            while (std::getline(File, Line))
+            {
+                std::vector<std::string> Fields;
+                std::stringstream Stream(Line);
+                std::string Field;
+                while (std::getline(Stream, Field, '\t'))
+                {
+                    Fields.push_back(Field);
+                }
+                if (Fields.size() != 6)
+                {
+                    continue;
+                }
+                try
+                {
+                    m_entries[key(Fields[0], Fields[1], Fields[2], Fields[3])] = {std::stoull(Fields[4]), std::stod(Fields[5])};
+                }
+                catch (const std::exception &)
+                {
+                    std::cerr << "Skipping malformed line in " << m_cachePath << "\n";
+                }
+            }
+        }
+
+        void save() const
+        {
+            std::ofstream File(m_cachePath);
+            if (!File)
+            {
+                std::cerr << "Could not write work-group size cache " << m_cachePath << "\n";
+                return;
+            }
+            for (const auto &Item : m_entries)
+            {
+                File << Item.first << "\t" << Item.second.WorkGroupSize << "\t" << Item.second.Time << "\n";
+            }
+        }
+
+        std::string m_device;
+        std::string m_driver;
+        std::size_t m_maxGroupSize;
+        std::string m_cachePath;
+        int m_reps;
+        std::map<std::string, Entry> m_entries;
+};
+
+/*
+    Time of one run as the tuner sees it, the variant's "Total Exec Time"
+    A run that rejected its configuration reports no events and never wins
+*/
+double total_exec_time(const std::vector<TimingEvent> &Events)
+{
+    for (const TimingEvent &Event : Events)
+    {
+        if (Event.Name == "Total Exec Time")
+        {
+            return Event.ExecTime;
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+#endif
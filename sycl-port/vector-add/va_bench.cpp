@@ -0,0 +1,239 @@
+/*
+    In-process benchmark driver for every vector-add variant
+    - One sycl::queue, context and arena for the whole sweep, so device
+      discovery, context creation and kernel JIT are paid once
+    - Sweeps vector sizes (powers of two) and work-group sizes with
+      configurable warm-up and repetition counts
+    - Repetitions are aggregated by TimingReport, one summary row per configuration
+
+    Usage: va_bench [--variants usm,gsq,sk,sk-sg,sk-ls,split,db] [--min-size N] [--max-size N]
+                    [--wg 32,64,...|auto] [--warmup N] [--reps N] [--format csv|json]
+                    [--trace trace.json] [--tune-cache wg_tuning.cache]
+
+    --wg auto measures only the work-group size WorkGroupTuner picks (or finds
+    in its cache) per variant and vector size
+*/
+#define VA_BENCH_DRIVER
+#include <functional>
+#include <sstream>
+#include "basic-add-usm/vector_add_usm.cpp"
+#include "gsq-add/vector_add_gsq.cpp"
+#include "single-kernel-multiQ-add/vector_add_sk_gmq.cpp"
+#include "split-kernel-multiQ-add/vector_add_split_gmq.cpp"
+#include "device-barrier-add/vector_add_db_gmq.cpp"
+#include "va_autotune.cpp"
+
+struct Strategy
+{
+    std::string Name;
+    bool UsesWorkGroups;
+    std::function<bool(sycl::queue &, DeviceArena &, std::size_t, std::size_t, std::vector<TimingEvent> &, EventTracer *)> Run;
+};
+
+std::vector<Strategy> all_strategies()
+{
+    return {
+        {"usm", false, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return basic_usm_add(Q, Arena, VecSize, Events, Tracer); }},
+        {"gsq", false, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return single_queue_add(Q, Arena, VecSize, Events, Tracer); }},
+        {"sk", true, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t WorkGroupSize, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return sk_multi_queue_add(Q, Arena, VecSize, WorkGroupSize, Events, Tracer); }},
+        {"sk-sg", true, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t WorkGroupSize, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return sk_subgroup_add(Q, Arena, VecSize, WorkGroupSize, Events, Tracer); }},
+        {"sk-ls", true, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t WorkGroupSize, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return sk_staged_add(Q, Arena, VecSize, WorkGroupSize, Events, Tracer); }},
+        {"split", true, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t WorkGroupSize, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return split_kernel_multi_queue_add(Q, Arena, VecSize, WorkGroupSize, Events, Tracer); }},
+        {"db", true, [](sycl::queue &Q, DeviceArena &Arena, std::size_t VecSize, std::size_t WorkGroupSize, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+            { return db_multi_queue_add(Q, Arena, VecSize, WorkGroupSize, Events, Tracer); }},
+    };
+}
+
+std::vector<std::string> split_list(const std::string &List)
+{
+    std::vector<std::string> Items;
+    std::stringstream Stream(List);
+    std::string Item;
+    while (std::getline(Stream, Item, ','))
+    {
+        if (!Item.empty()) Items.push_back(Item);
+    }
+    return Items;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> Variants{"usm", "gsq", "sk", "sk-sg", "sk-ls", "split", "db"};
+    std::size_t MinSize = 1 << 10;
+    std::size_t MaxSize = 1 << 20;
+    std::vector<std::size_t> WorkGroupSizes{32, 64, 128, 256, 512, 1024};
+    int WarmUp = 1;
+    int Reps = 10;
+    std::string Format = "csv";
+    std::string TracePath;
+    bool AutoTune = false;
+    std::string TuneCache = "wg_tuning.cache";
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string Flag = argv[i];
+        std::string Value = argv[i + 1];
+        if (Flag == "--variants") Variants = split_list(Value);
+        else if (Flag == "--min-size") MinSize = std::stoull(Value);
+        else if (Flag == "--max-size") MaxSize = std::stoull(Value);
+        else if (Flag == "--warmup") WarmUp = std::stoi(Value);
+        else if (Flag == "--reps") Reps = std::stoi(Value);
+        else if (Flag == "--format") Format = Value;
+        else if (Flag == "--trace") TracePath = Value;
+        else if (Flag == "--tune-cache") TuneCache = Value;
+        else if (Flag == "--wg" && Value == "auto") AutoTune = true;
+        else if (Flag == "--wg")
+        {
+            WorkGroupSizes.clear();
+            for (const std::string &Size : split_list(Value)) WorkGroupSizes.push_back(std::stoull(Size));
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << Flag << "\n";
+            return 1;
+        }
+    }
+    if (argc % 2 == 0 || MinSize == 0 || MinSize > MaxSize || (Format != "csv" && Format != "json"))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--variants usm,gsq,sk,sk-sg,sk-ls,split,db] [--min-size N] [--max-size N]"
+                  << " [--wg 32,64,...|auto] [--warmup N] [--reps N] [--format csv|json] [--trace trace.json]"
+                  << " [--tune-cache wg_tuning.cache]" << "\n";
+        return 1;
+    }
+
+    sycl::default_selector device_selector;
+    sycl::property_list props{sycl::property::queue::enable_profiling()}; // For measuring device execution times
+
+    sycl::queue Q(device_selector, props);
+    sycl::device Device = Q.get_device();
+
+    auto DevName = Device.get_info<sycl::info::device::name>();
+    auto MaxGroupSize = Device.get_info<sycl::info::device::max_work_group_size>();
+
+    // Candidates of the tuner, so the arena below is sized for all of them
+    WorkGroupTuner Tuner(Device, TuneCache);
+    if (AutoTune)
+    {
+        WorkGroupSizes = candidate_work_group_sizes(Device);
+    }
+
+    std::vector<Strategy> Selected;
+    for (const Strategy &Candidate : all_strategies())
+    {
+        if (std::find(Variants.begin(), Variants.end(), Candidate.Name) != Variants.end())
+        {
+            Selected.push_back(Candidate);
+        }
+    }
+    if (Selected.empty())
+    {
+        std::cerr << "No known variant selected (usm, gsq, sk, sk-sg, sk-ls, split, db)" << "\n";
+        return 1;
+    }
+
+    // One arena large enough for the biggest configuration in the sweep
+    std::size_t QueueBytes = ring_queues_footprint<int>(1, MaxSize);
+    std::size_t SubGroupBytes = sk_subgroup_footprint(MaxSize);
+    for (std::size_t WorkGroupSize : WorkGroupSizes)
+    {
+        if (WorkGroupSize > 0 && WorkGroupSize <= MaxSize)
+        {
+            QueueBytes = std::max(QueueBytes, ring_queues_footprint<int>(MaxSize / WorkGroupSize, WorkGroupSize));
+        }
+    }
+    DeviceArena Arena(Q, std::max(3 * DeviceArena::footprint<int>(MaxSize) + QueueBytes + DeviceArena::footprint<DeviceBarrier>(1),
+                                  SubGroupBytes) + verify_footprint());
+    if (Arena.capacity() == 0)
+    {
+        std::cerr << "Could not reserve the device arena" << "\n";
+        return 1;
+    }
+
+    TimingReport Report(DevName);
+    bool AllCorrect = true;
+
+    // Only measured repetitions are traced, warm-up runs are left out
+    EventTracer Tracer;
+    EventTracer *ActiveTracer = TracePath.empty() ? nullptr : &Tracer;
+    if (ActiveTracer)
+    {
+        Tracer.calibrate(Q);
+    }
+
+    try
+    {
+        for (std::size_t VecSize = MinSize; VecSize <= MaxSize; VecSize *= 2)
+        {
+            for (const Strategy &Variant : Selected)
+            {
+                std::vector<std::size_t> Sizes = Variant.UsesWorkGroups ? WorkGroupSizes : std::vector<std::size_t>{0};
+                if (Variant.UsesWorkGroups && AutoTune)
+                {
+                    std::size_t Best = Tuner.tune(Variant.Name, VecSize, WorkGroupSizes, [&](std::size_t WorkGroupSize)
+                    {
+                        std::vector<TimingEvent> Events;
+                        Variant.Run(Q, Arena, VecSize, WorkGroupSize, Events, nullptr);
+                        return total_exec_time(Events);
+                    });
+                    Sizes = {Best};
+                }
+                for (std::size_t WorkGroupSize : Sizes)
+                {
+                    if (Variant.UsesWorkGroups && !valid_work_group_size(VecSize, WorkGroupSize, MaxGroupSize))
+                    {
+                        continue;
+                    }
+
+                    std::vector<TimingEvent> Events;
+                    for (int Rep = 0; Rep < WarmUp; Rep++)
+                    {
+                        Variant.Run(Q, Arena, VecSize, WorkGroupSize, Events, nullptr);
+                    }
+                    Events.clear();
+
+                    for (int Rep = 0; Rep < Reps; Rep++)
+                    {
+                        AllCorrect &= Variant.Run(Q, Arena, VecSize, WorkGroupSize, Events, ActiveTracer);
+                    }
+
+                    Report.add(Variant.Name, Events);
+                }
+            }
+        }
+    }
+    catch (const std::length_error &Error)
+    {
+        std::cerr << Error.what() << "\n";
+        return 1;
+    }
+
+    if (Format == "json")
+    {
+        Report.write_json(std::cout);
+    }
+    else
+    {
+        Report.write_csv(std::cout);
+    }
+
+    if (ActiveTracer && !Tracer.write_file(TracePath))
+    {
+        std::cerr << "Could not write trace to " << TracePath << "\n";
+        return 1;
+    }
+
+    std::cerr << "Arena high water mark (bytes): " << Arena.high_water_mark() << "\n";
+
+    if (!AllCorrect)
+    {
+        std::cerr << "At least one measured run produced a wrong result!" << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,14 @@
+#ifndef _VA_PROFILER_CPP_
+#define _VA_PROFILER_CPP_
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
+#include <map>
+#include <tuple>
 #include <vector>
 #include <CL/sycl.hpp>
+#include "../sycl_utils.hpp"
 
 using u64 = uint64_t;
 using durationMiliSecs = std::chrono::duration<double, std::milli>;
@@ -18,4 +25,186 @@ struct TimingEvent
     std::string Name;
     std::size_t VectorSize;
     double ExecTime;
-};
\ No newline at end of file
+    std::size_t WorkGroupSize = 0; // 0 for variants without explicit work-groups
+};
+
+/*
+    Statistics over the repeated samples of one (variant, event, size, work-group size)
+*/
+struct TimingSummary
+{
+    std::string Variant;
+    std::string Name;
+    std::size_t VectorSize;
+    std::size_t WorkGroupSize;
+    std::size_t Samples;
+    double Min;
+    double Median;
+    double Mean;
+    double P95;
+    double P99;
+    double StdDev;
+    bool HasRate; // false for host spans that include setup, see TimingReport::host_span
+    double ElementsPerSec; // from the median
+    double GBPerSec; // from the median
+};
+
+/*
+    Aggregates TimingEvents in memory and reports one row per group
+    with a fixed schema, as CSV or JSON
+*/
+class TimingReport
+{
+public:
+    TimingReport(const std::string &Device, double BytesPerElement = 3 * sizeof(int))
+        : m_device(Device), m_bytesPerElement(BytesPerElement)
+    {
+    };
+
+    void add(const std::string &Variant, const TimingEvent &Event)
+    {
+        m_samples[{Variant, Event.Name, Event.VectorSize, Event.WorkGroupSize}].push_back(Event.ExecTime);
+    }
+
+    void add(const std::string &Variant, const std::vector<TimingEvent> &Events)
+    {
+        for (const TimingEvent &Event : Events)
+        {
+            add(Variant, Event);
+        }
+    }
+
+    std::vector<TimingSummary> summarize() const
+    {
+        std::vector<TimingSummary> Summaries;
+        for (const auto &Entry : m_samples)
+        {
+            std::vector<double> Sorted = Entry.second;
+            std::sort(Sorted.begin(), Sorted.end());
+
+            TimingSummary Summary;
+            std::tie(Summary.Variant, Summary.Name, Summary.VectorSize, Summary.WorkGroupSize) = Entry.first;
+            Summary.Samples = Sorted.size();
+            Summary.Min = Sorted.front();
+            Summary.Median = sorted_percentile(Sorted, 0.5);
+            Summary.P95 = sorted_percentile(Sorted, 0.95);
+            Summary.P99 = sorted_percentile(Sorted, 0.99);
+
+            double Sum = 0.0;
+            for (double Sample : Sorted) Sum += Sample;
+            Summary.Mean = Sum / Sorted.size();
+
+            double SquaredDiffs = 0.0;
+            for (double Sample : Sorted) SquaredDiffs += (Sample - Summary.Mean) * (Sample - Summary.Mean);
+            Summary.StdDev = Sorted.size() > 1 ? std::sqrt(SquaredDiffs / (Sorted.size() - 1)) : 0.0;
+
+            double Seconds = Summary.Median / 1000.0;
+            Summary.HasRate = !host_span(Summary.Name);
+            Summary.ElementsPerSec = Summary.HasRate && Seconds > 0.0 ? Summary.VectorSize / Seconds : 0.0;
+            Summary.GBPerSec = Summary.ElementsPerSec * m_bytesPerElement / 1e9;
+
+            Summaries.push_back(Summary);
+        }
+        return Summaries;
+    }
+
+    static std::string csv_header()
+    {
+        return "Variant,Event,VectorSize,WorkGroupSize,Device,Samples,Min(ms),Median(ms),Mean(ms),P95(ms),P99(ms),StdDev(ms),Elements/s,GB/s";
+    }
+
+    void write_csv(std::ostream &os, bool Header = true) const
+    {
+        if (Header)
+        {
+            os << csv_header() << "\n";
+        }
+        for (const TimingSummary &S : summarize())
+        {
+            os << csv_field(S.Variant) << "," << csv_field(S.Name) << "," << S.VectorSize << "," << S.WorkGroupSize << ","
+               << csv_field(m_device) << "," << S.Samples << "," << S.Min << "," << S.Median << "," << S.Mean << ","
+               << S.P95 << "," << S.P99 << "," << S.StdDev << ",";
+            if (S.HasRate)
+            {
+                os << S.ElementsPerSec << "," << S.GBPerSec;
+            }
+            else
+            {
+                os << ",";
+            }
+            os << "\n";
+        }
+    }
+
+    void write_json(std::ostream &os) const
+    {
+        os << "[\n";
+        std::vector<TimingSummary> Summaries = summarize();
+        for (std::size_t i = 0; i < Summaries.size(); i++)
+        {
+            const TimingSummary &S = Summaries[i];
+            os << "  {\"variant\": \"" << escape(S.Variant) << "\", \"event\": \"" << escape(S.Name)
+               << "\", \"vector_size\": " << S.VectorSize << ", \"work_group_size\": " << S.WorkGroupSize
+               << ", \"device\": \"" << escape(m_device) << "\", \"samples\": " << S.Samples
+               << ", \"min_ms\": " << S.Min << ", \"median_ms\": " << S.Median << ", \"mean_ms\": " << S.Mean
+               << ", \"p95_ms\": " << S.P95 << ", \"p99_ms\": " << S.P99 << ", \"stddev_ms\": " << S.StdDev
+               << ", \"elements_per_sec\": ";
+            if (S.HasRate)
+            {
+                os << S.ElementsPerSec << ", \"gb_per_sec\": " << S.GBPerSec;
+            }
+            else
+            {
+                os << "null, \"gb_per_sec\": null";
+            }
+            os << "}" << (i + 1 < Summaries.size() ? "," : "") << "\n";
+        }
+        os << "]\n";
+    }
+
+private:
+    using Key = std::tuple<std::string, std::string, std::size_t, std::size_t>;
+
+    /*
+        Host spans around memory setup or the whole run, their time is not
+        spent moving the vector so no throughput is reported for them
+    */
+    static bool host_span(const std::string &Name)
+    {
+        return Name == "Memory Setup Time" || Name == "Total Exec Time";
+    }
+
+    /*
+        Quote fields holding a comma, quote or line break, doubling inner quotes
+    */
+    static std::string csv_field(const std::string &Text)
+    {
+        if (Text.find_first_of(",\"\n") == std::string::npos)
+        {
+            return Text;
+        }
+        std::string Quoted = "\"";
+        for (char c : Text)
+        {
+            if (c == '"') Quoted += '"';
+            Quoted += c;
+        }
+        return Quoted + "\"";
+    }
+
+    static std::string escape(const std::string &Text)
+    {
+        std::string Escaped;
+        for (char c : Text)
+        {
+            if (c == '"' || c == '\\') Escaped += '\\';
+            Escaped += c;
+        }
+        return Escaped;
+    }
+
+    std::string m_device;
+    double m_bytesPerElement;
+    std::map<Key, std::vector<double>> m_samples;
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef _VA_TRACER_CPP_
+#define _VA_TRACER_CPP_
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <CL/sycl.hpp>
+#include "va_profiler.cpp"
+
+/*
+    Records SYCL command timelines (submit, start, end) and host-side
+    high_resolution_clock spans, and writes them as a Chrome trace /
+    Perfetto JSON file (open with chrome://tracing or ui.perfetto.dev)
+    - Device timestamps are shifted onto the host clock with an offset
+      measured by calibrate()
+    - Each command is drawn as a "queued" span (submit -> start) and an
+      execution span (start -> end), so launch gaps and Q.wait() stalls show up
+    - Timestamps are written in microseconds with fixed nanosecond
+      precision, long sweeps keep their resolution
+*/
+class EventTracer
+{
+public:
+    using TimePoint = std::chrono::high_resolution_clock::time_point;
+
+    EventTracer() : m_deviceOffsetNs(0)
+    {
+    };
+
+    /*
+        Estimate host clock - device clock with an empty kernel
+    */
+    void calibrate(sycl::queue &Q)
+    {
+        sycl::event Event = Q.single_task([=]() {});
+        Event.wait();
+        auto HostNow = std::chrono::high_resolution_clock::now();
+        u64 DeviceEnd = Event.get_profiling_info<sycl::info::event_profiling::command_end>();
+        m_deviceOffsetNs = to_ns(HostNow) - static_cast<std::int64_t>(DeviceEnd);
+    }
+
+    /*
+        Event must be complete and come from a queue with enable_profiling
+    */
+    void device(const std::string &Name, const sycl::event &Event)
+    {
+        std::int64_t Submit = Event.get_profiling_info<sycl::info::event_profiling::command_submit>() + m_deviceOffsetNs;
+        std::int64_t Start = Event.get_profiling_info<sycl::info::event_profiling::command_start>() + m_deviceOffsetNs;
+        std::int64_t End = Event.get_profiling_info<sycl::info::event_profiling::command_end>() + m_deviceOffsetNs;
+
+        m_spans.push_back({Name + " (queued)", DeviceQueuedTrack, Submit, Start});
+        m_spans.push_back({Name, DeviceExecTrack, Start, End});
+    }
+
+    void host(const std::string &Name, TimePoint Start, TimePoint End)
+    {
+        m_spans.push_back({Name, HostTrack, to_ns(Start), to_ns(End)});
+    }
+
+    void write(std::ostream &os) const
+    {
+        std::int64_t Origin = 0;
+        if (!m_spans.empty())
+        {
+            Origin = std::min_element(m_spans.begin(), m_spans.end(),
+                [](const Span &a, const Span &b) { return a.Start < b.Start; })->Start;
+        }
+
+        std::ios::fmtflags Flags = os.flags();
+        std::streamsize Precision = os.precision();
+        os << std::fixed << std::setprecision(3);
+
+        os << "{\"traceEvents\": [\n";
+        os << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"Host\"}},\n";
+        os << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"Device\"}},\n";
+        os << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"Queued\"}},\n";
+        os << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"Executing\"}}";
+        for (const Span &S : m_spans)
+        {
+            int Pid = S.Track == HostTrack ? 0 : 1;
+            int Tid = S.Track == DeviceExecTrack ? 1 : 0;
+            os << ",\n  {\"name\": \"" << escape(S.Name) << "\", \"ph\": \"X\", \"pid\": " << Pid << ", \"tid\": " << Tid
+               << ", \"ts\": " << (S.Start - Origin) / 1000.0 << ", \"dur\": " << (S.End - S.Start) / 1000.0 << "}";
+        }
+        os << "\n]}\n";
+
+        os.flags(Flags);
+        os.precision(Precision);
+    }
+
+    bool write_file(const std::string &Path) const
+    {
+        std::ofstream File(Path);
+        if (!File)
+        {
+            return false;
+        }
+        write(File);
+        return true;
+    }
+
+private:
+    enum TrackType { HostTrack, DeviceQueuedTrack, DeviceExecTrack };
+
+    struct Span
+    {
+        std::string Name;
+        TrackType Track;
+        std::int64_t Start; // ns on the host clock, integer so differences stay exact
+        std::int64_t End;
+    };
+
+    static std::string escape(const std::string &Text)
+    {
+        std::string Escaped;
+        for (char c : Text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                Escaped += '\\';
+                Escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char Code[7];
+                std::snprintf(Code, sizeof(Code), "\\u%04x", c);
+                Escaped += Code;
+            }
+            else
+            {
+                Escaped += c;
+            }
+        }
+        return Escaped;
+    }
+
+    static std::int64_t to_ns(TimePoint Time)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Time.time_since_epoch()).count();
+    }
+
+    std::int64_t m_deviceOffsetNs;
+    std::vector<Span> m_spans;
+};
+#endif
@@ -0,0 +1,31 @@
+#ifndef _VA_VERIFY_CPP_
+#define _VA_VERIFY_CPP_
+#include <CL/sycl.hpp>
+#include "../device_arena.hpp"
+#include "../device_verify.hpp"
+#include "va_profiler.cpp"
+#include "va_tracer.cpp"
+
+/*
+    Checks R on the device after the measured part of a variant
+    - Records the check as "Verify Kernel Exec Time" so its cost stays visible
+    - Call before Arena.reset(), the scratch ints come from the arena
+*/
+bool verify_vector_add(sycl::queue &Q, DeviceArena &Arena, const int *R, const std::size_t VecSize, const std::size_t WorkGroupSize,
+    const std::string &Variant, std::vector<TimingEvent> &Events, EventTracer *Tracer)
+{
+    sycl::event VerifyEvent;
+    VerifyResult Result = verify_on_device(Q, Arena, R, VecSize, ExpectedVectorAdd{}, &VerifyEvent);
+
+    auto StartVerifyExecTimePoint = VerifyEvent.get_profiling_info<sycl::info::event_profiling::command_start>();
+    auto EndVerifyExecTimePoint = VerifyEvent.get_profiling_info<sycl::info::event_profiling::command_end>();
+    Events.push_back({"Verify Kernel Exec Time", VecSize, to_mili(EndVerifyExecTimePoint - StartVerifyExecTimePoint), WorkGroupSize});
+
+    if (Tracer)
+    {
+        Tracer->device("Verify Kernel", VerifyEvent);
+    }
+
+    return report_verification(Variant, VecSize, Result);
+}
+#endif